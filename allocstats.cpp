@@ -0,0 +1,38 @@
+#include "allocstats.h"
+
+#ifdef PACMAN_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> allocations(0);
+static thread_local constinit bool countThisThread = false;
+
+bool allocationCountingEnabled() { return true; }
+uint64_t allocationCount() { return allocations.load(std::memory_order_relaxed); }
+void setAllocationCounting(bool on) { countThisThread = on; }
+bool isAllocationCountingOn() { return countThisThread; }
+
+// Replacements for the global allocation functions that count every call on a counted thread
+void* operator new(std::size_t size) {
+    if (countThisThread) { allocations.fetch_add(1, std::memory_order_relaxed); }
+    if (void* memory = std::malloc(size ? size : 1)) { return memory; }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+
+#else
+
+bool allocationCountingEnabled() { return false; }
+uint64_t allocationCount() { return 0; }
+void setAllocationCounting(bool) {}
+bool isAllocationCountingOn() { return false; }
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+
+#include <cstdint>
+
+// Debug counter of heap allocations, used to check that steady-state frames never allocate
+// Counting replaces the global operator new and is only compiled in with PACMAN_COUNT_ALLOCATIONS
+// Only threads that turned counting on are counted, so background threads such as
+// the metrics exporter or the level loader do not show up in the game's frames
+
+// Method to tell whether allocations are being counted in this build
+bool allocationCountingEnabled();
+
+// Method to return the number of operator new calls so far on counted threads, 0 when counting is off
+uint64_t allocationCount();
+
+// Method to count, or stop counting, the allocations of the calling thread (off for every new thread)
+void setAllocationCounting(bool on);
+
+// Method to tell whether the calling thread's allocations are counted
+bool isAllocationCountingOn();
+
+#endif // ALLOCSTATS_H
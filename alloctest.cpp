@@ -0,0 +1,113 @@
+// Checks that the per-frame game work never touches the heap once warmed up
+// Drives everything a frame does apart from the OpenGL calls: a simulation tick
+// with both sides played by MCTS bots, the frame arena pellet batch, the
+// spectator broadcast and the metrics updates, over several games, both alone
+// and with the metrics exporter running on its own thread
+// Built with PACMAN_COUNT_ALLOCATIONS and run by ctest
+
+#include "allocstats.h"
+#include "arena.h"
+#include "broadcast.h"
+#include "gamecore.h"
+#include "mcts.h"
+#include "metrics.h"
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+// Same sizes as the game's frame loop
+static const size_t kFrameArenaBytes = 64 * 1024;
+static const int kWarmupFrames = 120;
+static const int kMeasuredFrames = 3000;
+
+// Games are restarted at least this often so resets are measured too, as when R is pressed
+static const int kMaxGameFrames = 1000;
+
+// Exports far more often than the game's once a second, so many happen during the measured frames
+static const int kExportIntervalMs = 1;
+
+// Method to play warm-up and measured frames, returns the heap allocations of the measured ones
+static uint64_t measureFrames(GameCore& core, Arena& frameArena, MctsBot& pacmanBot, MctsBot& ghostBot,
+                              Broadcaster& broadcaster, int& games) {
+    uint64_t before = 0;
+    int gameFrames = 0;
+    games = 0;
+    for (int frame = 0; frame < kWarmupFrames + kMeasuredFrames; frame++) {
+        if (frame == kWarmupFrames) { before = allocationCount(); }
+        frameArena.reset();
+
+        // Same order as Game::keyOperations and Game::display
+        if (core.isOver() || ++gameFrames == kMaxGameFrames) {
+            if (core.isOver()) { metricsAdd(core.isWon() ? METRIC_GAMES_WON : METRIC_GAMES_LOST); }
+            gameFrames = 0;
+            core.reset();
+            pacmanBot.restart();
+            ghostBot.restart();
+            games++;
+        }
+        int eaten = core.step(pacmanBot.nextMove(core), ghostBot.nextMove(core));
+        broadcaster.publish(core, true);
+        metricsAdd(METRIC_TICKS);
+        if (eaten > 0) { metricsAdd(METRIC_POINTS, eaten); }
+        metricsSet(METRIC_SCORE, core.getScore());
+        metricsSet(METRIC_PELLETS_LEFT, core.getLevel().getPelletCount() - core.getPoints());
+
+        float* vertices = frameArena.createArray<float>(2 * core.getLevel().getPelletCount());
+        if (!vertices) {
+            printf("frame %d: the frame arena is too small for the pellet batch\n", frame);
+            return ~0ull;
+        }
+        int powerCount;
+        core.fillPelletVertices(vertices, 50.0f, powerCount);
+
+        metricsObserveFrame(16000);
+        metricsAdd(METRIC_FRAMES);
+    }
+    return allocationCount() - before;
+}
+
+int main() {
+    if (!allocationCountingEnabled()) {
+        printf("allocation counting is not compiled in\n");
+        return 1;
+    }
+
+    // As in the game, only this thread and the bots' helpers are counted
+    setAllocationCounting(true);
+    GameCore core;
+    Arena frameArena(kFrameArenaBytes);
+    MctsBot pacmanBot(SIDE_PACMAN, 2, 1.0);
+    MctsBot ghostBot(SIDE_GHOST, 2, 1.0);
+
+    char name[64];
+    snprintf(name, sizeof(name), "/pacman_alloctest_%d", (int)getpid());
+    Broadcaster broadcaster;
+    if (!broadcaster.open(name)) {
+        printf("cannot open the broadcast region %s\n", name);
+        return 1;
+    }
+
+    int games = 0;
+    uint64_t allocations = measureFrames(core, frameArena, pacmanBot, ghostBot, broadcaster, games);
+    printf("%d frames over %d game resets after warm-up: %llu heap allocations\n",
+           kMeasuredFrames, games, (unsigned long long)allocations);
+
+    // Again with the metrics exporter allocating on its own thread, which the game's frames must not see
+    char metricsPath[64];
+    snprintf(metricsPath, sizeof(metricsPath), "pacman_alloctest_%d", (int)getpid());
+    MetricsExporter exporter;
+    if (!exporter.start(metricsPath, kExportIntervalMs)) {
+        printf("cannot start the metrics exporter at %s\n", metricsPath);
+        return 1;
+    }
+    uint64_t exporterAllocations = measureFrames(core, frameArena, pacmanBot, ghostBot, broadcaster, games);
+    exporter.stop();
+    printf("%d frames over %d game resets with the metrics exporter running: %llu heap allocations\n",
+           kMeasuredFrames, games, (unsigned long long)exporterAllocations);
+
+    remove((std::string(metricsPath) + ".prom").c_str());
+    remove((std::string(metricsPath) + ".page").c_str());
+    broadcaster.close();
+    return allocations == 0 && exporterAllocations == 0 ? 0 : 1;
+}
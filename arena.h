@@ -0,0 +1,54 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Bump allocator over one buffer reserved up front
+// Objects are never freed one by one; reset() releases everything at once,
+// so nothing placed here may own resources that need a destructor
+class Arena {
+private:
+    std::unique_ptr<unsigned char[]> buffer;
+    size_t capacity;
+    size_t used;
+
+public:
+    // Arena constructor to reserve the whole buffer once
+    explicit Arena(size_t bytes) : buffer(new unsigned char[bytes]), capacity(bytes), used(0) {}
+
+    Arena(Arena&&) = default;
+    Arena& operator=(Arena&&) = default;
+
+    // Method to carve out size bytes, returns nullptr once the arena is full
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(buffer.get());
+        size_t offset = ((base + used + align - 1) & ~(uintptr_t)(align - 1)) - base;
+        if (offset + size > capacity) { return nullptr; }
+        used = offset + size;
+        return buffer.get() + offset;
+    }
+
+    // Method to construct a T inside the arena, returns nullptr once the arena is full
+    template <class T, class... Args>
+    T* create(Args&&... args) {
+        void* memory = allocate(sizeof(T), alignof(T));
+        return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    // Method to construct count default-initialized Ts, returns nullptr once the arena is full
+    template <class T>
+    T* createArray(size_t count) {
+        void* memory = allocate(sizeof(T) * count, alignof(T));
+        return memory ? new (memory) T[count] : nullptr;
+    }
+
+    void reset() { used = 0; }
+    size_t getUsed() const { return used; }
+    size_t getCapacity() const { return capacity; }
+};
+
+#endif // ARENA_H
@@ -0,0 +1,189 @@
+#include "broadcast.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring needs lock-free 64-bit atomics");
+
+static int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ** BROADCASTER **
+
+bool Broadcaster::open(const char* shmName) {
+    close();
+
+    int fd = shm_open(shmName, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("shm_open");
+        return false;
+    }
+    if (ftruncate(fd, sizeof(BroadcastRegion)) != 0) {
+        perror("ftruncate");
+        ::close(fd);
+        shm_unlink(shmName);
+        return false;
+    }
+    void* memory = mmap(nullptr, sizeof(BroadcastRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(shmName);
+        return false;
+    }
+
+    // Mark every slot empty before readers can see a valid header
+    region = static_cast<BroadcastRegion*>(memory);
+    for (uint32_t i = 0; i < BroadcastRegion::kSlots; i++) {
+        region->slots[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    region->head.store(0, std::memory_order_relaxed);
+    region->slotCount = BroadcastRegion::kSlots;
+    region->frameSize = sizeof(BroadcastFrame);
+    region->version = BroadcastRegion::kVersion;
+    std::atomic_thread_fence(std::memory_order_release);
+    region->magic = BroadcastRegion::kMagic;
+
+    snprintf(name, sizeof(name), "%s", shmName);
+    sequence = 0;
+    lastPelletWords = 0;
+    return true;
+}
+
+void Broadcaster::close() {
+    if (!region) { return; }
+    munmap(region, sizeof(BroadcastRegion));
+    shm_unlink(name);
+    region = nullptr;
+}
+
+void Broadcaster::publish(const GameCore& core, bool replay) {
+    if (!region) { return; }
+
+    // A keyframe is needed on schedule and whenever pellets came back after a reset
+    const uint64_t* pellets = core.getPelletWords();
+    int words = core.getPelletWordCount();
+    bool keyframe = sequence % kKeyframeInterval == 0 || words != lastPelletWords;
+    for (int i = 0; i < words; i++) {
+        if (pellets[i] & ~lastPellets[i]) { keyframe = true; }
+    }
+
+    BroadcastSlot& slot = region->slots[sequence % BroadcastRegion::kSlots];
+    slot.sequence.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    BroadcastFrame& frame = slot.frame;
+    frame.sequence = sequence;
+    frame.tick = core.getTick();
+    frame.publishNanos = nowNanos();
+    frame.pacmanX = core.getPacmanPosX();
+    frame.pacmanY = core.getPacmanPosY();
+    frame.ghostX = core.getGhostPosX();
+    frame.ghostY = core.getGhostPosY();
+    frame.rotation = core.getRotation();
+    frame.points = core.getPoints();
+    frame.score = core.getScore();
+    for (int i = 0; i < words; i++) {
+        frame.pellets[i] = keyframe ? pellets[i] : lastPellets[i] & ~pellets[i];
+        lastPellets[i] = pellets[i];
+    }
+    frame.pelletWords = (uint8_t)words;
+    lastPelletWords = words;
+    frame.keyframe = keyframe;
+    frame.over = core.isOver();
+    frame.replay = replay;
+    frame.ghostState = core.getGhostState();
+    frame.bonusActive = core.isBonusActive();
+    frame.rows = (uint8_t)core.getRows();
+    frame.cols = (uint8_t)core.getCols();
+
+    slot.sequence.store(2 * (sequence + 1), std::memory_order_release);
+    region->head.store(++sequence, std::memory_order_release);
+}
+
+// ** SPECTATOR **
+
+bool Spectator::open(const char* shmName) {
+    close();
+
+    int fd = shm_open(shmName, O_RDONLY, 0);
+    if (fd < 0) { return false; }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size < sizeof(BroadcastRegion)) {
+        ::close(fd);
+        return false;
+    }
+    void* memory = mmap(nullptr, sizeof(BroadcastRegion), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) { return false; }
+
+    const BroadcastRegion* candidate = static_cast<const BroadcastRegion*>(memory);
+    if (candidate->magic != BroadcastRegion::kMagic || candidate->version != BroadcastRegion::kVersion ||
+        candidate->slotCount != BroadcastRegion::kSlots || candidate->frameSize != sizeof(BroadcastFrame)) {
+        munmap(memory, sizeof(BroadcastRegion));
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // Start following from the newest frame
+    region = candidate;
+    regionBytes = sizeof(BroadcastRegion);
+    uint64_t head = region->head.load(std::memory_order_acquire);
+    nextSequence = head > 0 ? head - 1 : 0;
+    skipped = 0;
+    return true;
+}
+
+void Spectator::close() {
+    if (!region) { return; }
+    munmap(const_cast<BroadcastRegion*>(region), regionBytes);
+    region = nullptr;
+}
+
+uint64_t Spectator::getLag() const {
+    uint64_t head = region->head.load(std::memory_order_acquire);
+    return head > nextSequence ? head - nextSequence : 0;
+}
+
+Spectator::Result Spectator::read(BroadcastFrame& frame) {
+    for (;;) {
+        uint64_t head = region->head.load(std::memory_order_acquire);
+        if (nextSequence >= head) { return NO_NEW_FRAME; }
+
+        // Fell more than half a ring behind: skip ahead to frames the writer will not reuse soon
+        if (head - nextSequence > BroadcastRegion::kSlots / 2) {
+            uint64_t resume = head - BroadcastRegion::kSlots / 2;
+            skipped += resume - nextSequence;
+            nextSequence = resume;
+        }
+
+        const BroadcastSlot& slot = region->slots[nextSequence % BroadcastRegion::kSlots];
+        uint64_t expected = 2 * (nextSequence + 1);
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == expected) {
+            // The word count may be torn too; it is clamped here and the sequence check below rejects the copy
+            memcpy(&frame, &slot.frame, offsetof(BroadcastFrame, pellets));
+            if (frame.pelletWords > GameCore::kPelletWords) { frame.pelletWords = GameCore::kPelletWords; }
+            memcpy(frame.pellets, slot.frame.pellets, frame.pelletWords * sizeof(uint64_t));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == expected) {
+                nextSequence++;
+                return FRAME_READ;
+            }
+        }
+
+        // The writer reused the slot while we were reading; the next pass skips ahead
+        if (before > expected || slot.sequence.load(std::memory_order_relaxed) > expected) {
+            skipped++;
+            nextSequence++;
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include <atomic>
+#include <cstdint>
+#include "gamecore.h"
+
+// Live game state published to other processes through POSIX shared memory
+// One writer fills a ring of slots and never waits; any number of readers
+// follow it and detect torn or overwritten slots with a per-slot sequence
+
+// Compact state of one tick
+// Pellets are sent as the bits eaten since the previous tick, except on
+// keyframes (every kKeyframeInterval frames and after a reset) which carry
+// the full set so a late reader can start from them
+// Only the first pelletWords words of pellets are written and read, so a
+// small maze costs no more than it needs; pellets must stay the last field
+struct BroadcastFrame {
+    uint64_t sequence; // position in the ring, one per frame published
+    uint64_t tick;     // simulation tick of the game, as GameCore::getTick()
+    int64_t publishNanos;
+    int32_t pacmanX;
+    int32_t pacmanY;
+    int32_t ghostX;
+    int32_t ghostY;
+    int32_t rotation;
+    int32_t points;
+    int32_t score;
+    uint8_t keyframe;
+    uint8_t over;
+    uint8_t replay;
+    uint8_t ghostState;
+    uint8_t bonusActive;
+    uint8_t rows; // maze size, to lay out the pellet bits
+    uint8_t cols;
+    uint8_t pelletWords;
+    uint64_t pellets[GameCore::kPelletWords];
+};
+
+struct alignas(64) BroadcastSlot {
+    // 2 * (sequence + 1) once the frame with that sequence is complete, odd while it is being written
+    std::atomic<uint64_t> sequence;
+    BroadcastFrame frame;
+};
+
+struct BroadcastRegion {
+    static constexpr uint32_t kMagic = 0x50414342; // "PACB"
+    static constexpr uint32_t kVersion = 5;
+    static constexpr uint32_t kSlots = 1024;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t frameSize;
+    alignas(64) std::atomic<uint64_t> head; // number of frames published so far
+    BroadcastSlot slots[kSlots];
+};
+
+// Writer side, owned by the game
+class Broadcaster {
+private:
+    BroadcastRegion* region;
+    char name[64];
+    uint64_t sequence;
+    int lastPelletWords;
+    uint64_t lastPellets[GameCore::kPelletWords];
+
+public:
+    static constexpr uint64_t kKeyframeInterval = 64;
+
+    // Broadcaster constructor, nothing is shared until open() succeeds
+    Broadcaster() : region(nullptr), name(), sequence(0), lastPelletWords(0), lastPellets() {}
+    ~Broadcaster() { close(); }
+
+    Broadcaster(const Broadcaster&) = delete;
+    Broadcaster& operator=(const Broadcaster&) = delete;
+
+    // Method to create the shared memory object, e.g. "/pacman", returns false on failure
+    bool open(const char* shmName);
+    void close();
+    bool isOpen() const { return region != nullptr; }
+
+    // Method to publish the state right after a simulation tick, once per tick
+    void publish(const GameCore& core, bool replay);
+};
+
+// Reader side, used by spectator processes
+class Spectator {
+private:
+    const BroadcastRegion* region;
+    uint64_t regionBytes;
+    uint64_t nextSequence;
+    uint64_t skipped;
+
+public:
+    // Outcome of one read attempt
+    enum Result { FRAME_READ, NO_NEW_FRAME };
+
+    Spectator() : region(nullptr), regionBytes(0), nextSequence(0), skipped(0) {}
+    ~Spectator() { close(); }
+
+    Spectator(const Spectator&) = delete;
+    Spectator& operator=(const Spectator&) = delete;
+
+    // Method to attach to a running broadcast, returns false if there is none or it is incompatible
+    bool open(const char* shmName);
+    void close();
+
+    // Method to read the next frame, jumping ahead if the writer lapped us
+    Result read(BroadcastFrame& frame);
+
+    // Frames published but not read yet
+    uint64_t getLag() const;
+
+    // Frames that were overwritten before they could be read
+    uint64_t getSkipped() const { return skipped; }
+};
+
+#endif // BROADCAST_H
@@ -1,15 +1,26 @@
 #ifndef GAME_H
 #define GAME_H
+#include <chrono>
 #include <vector>
 #include <deque>
 #include <string>
+#ifdef __APPLE__
 #include <OpenGL/gl.h>
 #include <GLUT/glut.h>
+#else
+#include <GL/gl.h>
+#include <GL/glut.h>
+#endif
+#include "arena.h"
+#include "gamecore.h"
 
 // Forward declaration of Pacman and Ghost classes
 class Pacman;
 class Ghost;
 class Drawable;
+class MctsBot;
+class Broadcaster;
+class LevelManager;
 
 class Game {
 private:
@@ -18,45 +29,42 @@ private:
     bool replay;
     bool over;
     float squareSize;
-    float xIncrementp;
-    float yIncrementp;
-    float xIncrementg;
-    float yIncrementg;
     int rotation;
     std::vector<int> border;
     std::vector<int> obstaclesTop;
     std::vector<int> obstaclesMiddle;
     std::vector<int> obstaclesBottom;
     std::deque<float> food;
-    std::vector<std::vector<bool>> bitmap1;
-    int points;
+    GameCore core;
+    MctsBot* pacmanBot;
+    MctsBot* ghostBot;
+    Broadcaster* broadcaster;
+    LevelManager* levels;
     std::vector<Drawable*> drawables;
-    bool moveUp;
-    bool moveDown;
-    bool moveLeft;
-    bool moveRight;
-    float x_p;
-    float y_p;
-    float x_g;
-    float y_g;
-    std::vector<float> foodPositions;
+    Arena frameArena;
+    long frameCount;
+    std::chrono::steady_clock::time_point lastFrameStart;
 
 public:
     Game(Pacman& p, Ghost& g);
     virtual ~Game();
     void init();
+    void setBots(MctsBot* pacmanPlayer, MctsBot* ghostPlayer);
+    void setBroadcaster(Broadcaster* spectators);
+    void setLevels(LevelManager* levelList);
     void drawLaberynth();
-    bool foodEaten(int x, int y, float pacmanX, float pacmanY);
-    void drawFood(float pacmanX, float pacmanY);    
+    void drawFood();
     void keyPressed(unsigned char key, int x, int y);
     void keyUp(unsigned char key, int x, int y);
     void resetGame();
+    void publishGauges();
     void keyOperations();
     void gameOver();
     void resultsDisplay();
     void welcomeScreen();
     void display();
     void reshape(int w, int h);
+    void setView(float width, float height);
     std::vector<bool> keyStates;
 };
 
@@ -0,0 +1,248 @@
+#include "gamecore.h"
+
+#include <cstdlib>
+#include <cstring>
+
+// Distances in sub-cell units: the mouth reaches 16 px past Pacman's centre,
+// food within just under 16 px of it is eaten, and the ghost catches within 10 px
+static const int32_t kMouthReach = 32;
+static const int32_t kEatRadius = 31;
+static const int32_t kCatchRadius = 20;
+
+// Method to return the centre of a cell in sub-cell units
+static inline int32_t cellCentre(int index) { return index * GameCore::kSubCell + GameCore::kSubCell / 2; }
+
+GameCore::GameCore(const Level* startLevel) : level(startLevel ? startLevel : Level::builtin().get()), pellets() { reset(); }
+
+void GameCore::setLevel(const Level* newLevel) {
+    // Clear the words a larger maze may have left behind, reset() only refills the ones in use
+    for (int i = 0; i < kPelletWords; i++) { pellets[i] = 0; }
+    level = newLevel;
+    reset();
+}
+
+void GameCore::reset() {
+    over = false;
+    int cols = level->getCols();
+    pacmanX = cellCentre(level->getPacmanStart() % cols);
+    pacmanY = cellCentre(level->getPacmanStart() / cols);
+    ghostX = cellCentre(level->getGhostHome() % cols);
+    ghostY = cellCentre(level->getGhostHome() / cols);
+    rotation = 0;
+    points = 0;
+    score = 0;
+    ghostState = GHOST_CHASING;
+    bonusActive = false;
+
+    // Drop every pending event; the first bonus item shows up after a while
+    timers.clear();
+    frightenedTimer = timers.kNone;
+    respawnTimer = timers.kNone;
+    bonusTimer = level->hasBonus() ? timers.schedule(kBonusSpawnTicks, EVENT_BONUS_SPAWN) : timers.kNone;
+
+    // Put a pellet back on every food position
+    const uint64_t* start = level->getPelletWords();
+    pelletWords = level->getPelletWordCount();
+    for (int i = 0; i < pelletWords; i++) { pellets[i] = start[i]; }
+}
+
+int GameCore::eatFood() {
+    // Pellets sit at cell centres, so only the pellet of the cell under Pacman
+    // can be within the radius of his mouth
+    int col = pacmanX / kSubCell;
+    int row = pacmanY / kSubCell;
+    int cell = row * level->getCols() + col;
+    if (!hasPellet(cell)) { return 0; }
+
+    int32_t foodX = cellCentre(col);
+    int32_t foodY = cellCentre(row);
+    if (abs(foodX - pacmanX) <= kEatRadius && abs(foodY - pacmanY) <= kEatRadius) {
+        pellets[cell >> 6] &= ~(1ull << (cell & 63));
+        points++;
+        if (!level->isPowerPellet(cell)) {
+            score += kPelletScore;
+            return 1;
+        }
+
+        // A power pellet frightens the ghost, or keeps it frightened for longer
+        score += kPowerPelletScore;
+        if (ghostState != GHOST_HOME) {
+            ghostState = GHOST_FRIGHTENED;
+            timers.cancel(frightenedTimer);
+            frightenedTimer = timers.schedule(kFrightenedTicks, EVENT_FRIGHTENED_END);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+void GameCore::eatBonus() {
+    int32_t bonusX = cellCentre(level->getBonusCell() % level->getCols());
+    int32_t bonusY = cellCentre(level->getBonusCell() / level->getCols());
+    if (!bonusActive || abs(bonusX - pacmanX) > kEatRadius || abs(bonusY - pacmanY) > kEatRadius) { return; }
+
+    // Eaten before it expired, so the expiry is replaced by the next spawn
+    bonusActive = false;
+    score += kBonusScore;
+    timers.cancel(bonusTimer);
+    bonusTimer = timers.schedule(kBonusSpawnTicks, EVENT_BONUS_SPAWN);
+}
+
+void GameCore::onEvent(uint32_t event) {
+    switch (event) {
+        case EVENT_FRIGHTENED_END:
+            frightenedTimer = timers.kNone;
+            if (ghostState == GHOST_FRIGHTENED) { ghostState = GHOST_CHASING; }
+            break;
+        case EVENT_GHOST_RESPAWN:
+            respawnTimer = timers.kNone;
+            ghostState = GHOST_CHASING;
+            break;
+        case EVENT_BONUS_SPAWN:
+            bonusActive = true;
+            bonusTimer = timers.schedule(kBonusLifetimeTicks, EVENT_BONUS_EXPIRE);
+            break;
+        case EVENT_BONUS_EXPIRE:
+            bonusActive = false;
+            bonusTimer = timers.schedule(kBonusSpawnTicks, EVENT_BONUS_SPAWN);
+            break;
+    }
+}
+
+int GameCore::step(uint8_t pacmanMoves, uint8_t ghostMoves) {
+    if (over) { return 0; }
+
+    // Fire the events that are due on this tick
+    timers.advance([this](int, uint32_t event) { onEvent(event); });
+
+    int32_t x_p = pacmanX;
+    int32_t y_p = pacmanY;
+
+    // Move Pacman unless the edge of his mouth would enter a wall
+    if (pacmanMoves & MOVE_LEFT) {
+        x_p -= kPacmanSpeed;
+        if (!level->isWall((x_p - kMouthReach) / kSubCell, y_p / kSubCell)) {
+            pacmanX -= kPacmanSpeed;
+            rotation = 2;
+        }
+    }
+
+    if (pacmanMoves & MOVE_RIGHT) {
+        x_p += kPacmanSpeed;
+        if (!level->isWall((x_p + kMouthReach) / kSubCell, y_p / kSubCell)) {
+            pacmanX += kPacmanSpeed;
+            rotation = 0;
+        }
+    }
+
+    if (pacmanMoves & MOVE_UP) {
+        y_p -= kPacmanSpeed;
+        if (!level->isWall(x_p / kSubCell, (y_p - kMouthReach) / kSubCell)) {
+            pacmanY -= kPacmanSpeed;
+            rotation = 3;
+        }
+    }
+
+    if (pacmanMoves & MOVE_DOWN) {
+        y_p += kPacmanSpeed;
+        if (!level->isWall(x_p / kSubCell, (y_p + kMouthReach) / kSubCell)) {
+            pacmanY += kPacmanSpeed;
+            rotation = 1;
+        }
+    }
+
+    // The ghost floats freely over the maze, slower while frightened and not at all while waiting at home
+    if (ghostState != GHOST_HOME) {
+        int32_t speed = ghostState == GHOST_FRIGHTENED ? kFrightenedSpeed : kGhostSpeed;
+        if (ghostMoves & MOVE_LEFT) { ghostX -= speed; }
+        if (ghostMoves & MOVE_RIGHT) { ghostX += speed; }
+        if (ghostMoves & MOVE_UP) { ghostY -= speed; }
+        if (ghostMoves & MOVE_DOWN) { ghostY += speed; }
+    }
+
+    int eaten = eatFood();
+    eatBonus();
+
+    // Meeting the ghost ends the game, unless it is frightened: then it is sent home to respawn
+    if (abs(ghostX - pacmanX) <= kCatchRadius && abs(ghostY - pacmanY) <= kCatchRadius) {
+        if (ghostState == GHOST_CHASING) {
+            over = true;
+        } else if (ghostState == GHOST_FRIGHTENED) {
+            score += kGhostScore;
+            ghostState = GHOST_HOME;
+            ghostX = cellCentre(level->getGhostHome() % level->getCols());
+            ghostY = cellCentre(level->getGhostHome() / level->getCols());
+            timers.cancel(frightenedTimer);
+            frightenedTimer = timers.kNone;
+            respawnTimer = timers.schedule(kRespawnTicks, EVENT_GHOST_RESPAWN);
+        }
+    }
+
+    // The game is also over once every pellet is eaten
+    if (isWon()) {
+        over = true;
+    }
+    return eaten;
+}
+
+uint64_t GameCore::stateHash() const {
+    // FNV-1a over every field that affects the rest of the game
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (value >> (8 * i)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+    for (int i = 0; i < pelletWords; i++) { mix(pellets[i]); }
+    mix((uint32_t)pacmanX);
+    mix((uint32_t)pacmanY);
+    mix((uint32_t)ghostX);
+    mix((uint32_t)ghostY);
+    mix((uint64_t)rotation << 32 | (uint32_t)points);
+    mix((uint64_t)(uint32_t)score << 32 | (uint64_t)ghostState << 16 | (uint64_t)bonusActive << 8 | over);
+    mix(timers.getNow());
+    mix(timers.isPending(frightenedTimer) ? timers.remaining(frightenedTimer) : ~0ull);
+    mix(timers.isPending(respawnTimer) ? timers.remaining(respawnTimer) : ~0ull);
+    mix(timers.isPending(bonusTimer) ? timers.remaining(bonusTimer) : ~0ull);
+    return hash;
+}
+
+int GameCore::fillPelletVertices(float* vertices, float cellSize, int& powerCount) const {
+    int capacity = level->getPelletCount();
+    int count = 0;
+    powerCount = 0;
+    for (int y = 0; y < level->getRows(); ++y) {
+        for (int x = 0; x < level->getCols(); ++x) {
+            if (hasPellet(x, y)) {
+                int i = isPowerPellet(x, y) ? capacity - ++powerCount : count++;
+                vertices[2 * i] = (x + 0.5f) * cellSize;
+                vertices[2 * i + 1] = (y + 0.5f) * cellSize;
+            }
+        }
+    }
+    return count;
+}
+
+void GameCore::writeObservation(uint8_t* planes) const {
+    int rows = level->getRows();
+    int cols = level->getCols();
+    int cells = level->getCells();
+    uint8_t* walls = planes;
+    uint8_t* food = planes + cells;
+    uint8_t* pacmanPlane = planes + 2 * cells;
+    uint8_t* ghostPlane = planes + 3 * cells;
+
+    for (int i = 0; i < cells; i++) { walls[i] = level->isWall(i); }
+    for (int i = 0; i < cells; i++) { food[i] = hasPellet(i); }
+    for (int i = 0; i < level->getPowerPelletCount(); i++) { food[level->getPowerPelletCell(i)] *= 2; }
+    if (bonusActive) { food[level->getBonusCell()] = 3; }
+
+    memset(pacmanPlane, 0, 2 * cells);
+    pacmanPlane[(pacmanY / kSubCell) * cols + pacmanX / kSubCell] = 1;
+
+    // The ghost is not confined to the maze, so only mark it while it is on the board
+    if (ghostX >= 0 && ghostX < cols * kSubCell && ghostY >= 0 && ghostY < rows * kSubCell) {
+        ghostPlane[(ghostY / kSubCell) * cols + ghostX / kSubCell] = 1 + ghostState;
+    }
+}
@@ -0,0 +1,165 @@
+#ifndef GAMECORE_H
+#define GAMECORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "level.h"
+#include "timerwheel.h"
+
+// Movement bits for one player during a single simulation tick
+// More than one bit may be set, exactly like holding several keys at once
+enum Move : uint8_t {
+    MOVE_NONE = 0,
+    MOVE_LEFT = 1,
+    MOVE_RIGHT = 2,
+    MOVE_UP = 4,
+    MOVE_DOWN = 8
+};
+
+// What the ghost is doing
+enum GhostState : uint8_t {
+    GHOST_CHASING = 0,
+    GHOST_FRIGHTENED,
+    GHOST_HOME
+};
+
+// Timed events of a game, all driven by the game's timer wheel
+enum GameEvent : uint32_t {
+    EVENT_FRIGHTENED_END = 0,
+    EVENT_GHOST_RESPAWN,
+    EVENT_BONUS_SPAWN,
+    EVENT_BONUS_EXPIRE
+};
+
+// Headless simulation of one game of Pacman vs. Ghost
+// Holds no OpenGL state so it can be stepped without a window and copied cheaply
+// Positions and speeds are integers in sub-cell units, so a game replays
+// bit for bit on any build; floats only appear in the getters used to draw
+// The maze comes from a Level, which must outlive every GameCore playing on it
+class GameCore {
+public:
+    static constexpr int kPelletWords = Level::kMaxPelletWords;
+
+    // One cell is kSubCell units wide, two units per pixel at the drawn size of 50
+    static constexpr int32_t kSubCell = 100;
+    static constexpr int32_t kPacmanSpeed = 4;
+    static constexpr int32_t kGhostSpeed = 3;
+    static constexpr int32_t kFrightenedSpeed = 2;
+
+    // Durations in ticks
+    static constexpr int kFrightenedTicks = 360;
+    static constexpr int kRespawnTicks = 180;
+    static constexpr int kBonusSpawnTicks = 900;
+    static constexpr int kBonusLifetimeTicks = 450;
+
+    // Score for each thing Pacman eats
+    static constexpr int kPelletScore = 10;
+    static constexpr int kPowerPelletScore = 50;
+    static constexpr int kGhostScore = 200;
+    static constexpr int kBonusScore = 100;
+
+    // GameCore constructor to start a fresh game, on the built-in maze unless a level is given
+    explicit GameCore(const Level* level = nullptr);
+
+    // Copies skip the pellet words the maze does not use, which is most of them on small mazes
+    GameCore(const GameCore& other) { copyFrom(other); }
+    GameCore& operator=(const GameCore& other) {
+        copyFrom(other);
+        return *this;
+    }
+
+    // Method to put every pellet back and move both players to their start
+    void reset();
+
+    // Method to switch to another maze and start a fresh game on it
+    void setLevel(const Level* newLevel);
+    const Level& getLevel() const { return *level; }
+    int getRows() const { return level->getRows(); }
+    int getCols() const { return level->getCols(); }
+
+    // Method to advance the game by one tick, returns the number of pellets eaten
+    int step(uint8_t pacmanMoves, uint8_t ghostMoves);
+
+    bool isOver() const { return over; }
+    bool isWon() const { return points == level->getPelletCount(); }
+    int getPoints() const { return points; }
+    int getScore() const { return score; }
+    int getRotation() const { return rotation; }
+    uint64_t getTick() const { return timers.getNow(); }
+    GhostState getGhostState() const { return ghostState; }
+    bool isBonusActive() const { return bonusActive; }
+
+    // Positions of both players in sub-cell units, as used by the simulation
+    int32_t getPacmanPosX() const { return pacmanX; }
+    int32_t getPacmanPosY() const { return pacmanY; }
+    int32_t getGhostPosX() const { return ghostX; }
+    int32_t getGhostPosY() const { return ghostY; }
+
+    // Pacman position in cells, as passed to Pacman::draw
+    float getPacmanX() const { return (float)pacmanX / kSubCell; }
+    float getPacmanY() const { return (float)pacmanY / kSubCell; }
+
+    // Ghost position as passed to Ghost::draw, which adds 7.5 cells worth of pixels
+    float getGhostX() const { return ghostX * 0.5f - 7.5f * 50.0f; }
+    float getGhostY() const { return ghostY * 0.5f - 7.5f * 50.0f; }
+
+    bool isWall(int col, int row) const { return level->isWall(col, row); }
+    bool hasPellet(int col, int row) const { return hasPellet(row * level->getCols() + col); }
+    bool hasPellet(int cell) const { return (pellets[cell >> 6] >> (cell & 63)) & 1; }
+    bool isPowerPellet(int col, int row) const { return level->isPowerPellet(row * level->getCols() + col); }
+
+    // Pellets still on the board, bit i of the set is cell i in row-major order
+    // Only the first getPelletWordCount() words belong to the maze being played
+    const uint64_t* getPelletWords() const { return pellets; }
+    int getPelletWordCount() const { return pelletWords; }
+
+    // Method to write the centre of every remaining pellet as an (x, y) pair in pixels of cellSize
+    // vertices needs room for getLevel().getPelletCount() pairs; pellets fill it from the front and
+    // power pellets from the back. Returns the number of pellets and sets powerCount
+    int fillPelletVertices(float* vertices, float cellSize, int& powerCount) const;
+
+    // Method to hash the whole simulation state, equal hashes on two machines mean they are in sync
+    uint64_t stateHash() const;
+
+    // Method to write the wall, pellet, Pacman and ghost planes (rows * cols bytes each)
+    // Pellet plane: 1 pellet, 2 power pellet, 3 bonus item; ghost plane: 1 chasing, 2 frightened, 3 home
+    void writeObservation(uint8_t* planes) const;
+
+private:
+    const Level* level;
+    int32_t pacmanX;
+    int32_t pacmanY;
+    int32_t ghostX;
+    int32_t ghostY;
+    int rotation;
+    int points;
+    int score;
+    bool over;
+    GhostState ghostState;
+    bool bonusActive;
+    TimerWheel<8, 5, 3> timers;
+    int frightenedTimer;
+    int respawnTimer;
+    int bonusTimer;
+
+    // Kept last so a copy can stop after the words the maze uses
+    int pelletWords;
+    uint64_t pellets[kPelletWords];
+
+    // Method to copy every field, then only the pellet words other uses
+    void copyFrom(const GameCore& other) {
+        memcpy((void*)this, (const void*)&other, offsetof(GameCore, pellets) + other.pelletWords * sizeof(uint64_t));
+    }
+
+    // Method to remove the pellet under Pacman's mouth, if there is one
+    int eatFood();
+
+    // Method to eat the bonus item if Pacman is on it
+    void eatBonus();
+
+    // Method to react to a timer of the wheel firing
+    void onEvent(uint32_t event);
+};
+
+#endif // GAMECORE_H
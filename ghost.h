@@ -4,8 +4,13 @@
 
 #include <cmath>
 #include <atomic>
+#ifdef __APPLE__
 #include <OpenGL/gl.h>
 #include <GLUT/glut.h>
+#else
+#include <GL/gl.h>
+#include <GL/glut.h>
+#endif
 
 class Ghost {
 private:
@@ -14,13 +19,17 @@ private:
     static constexpr float squareSize = 50.0;
     float posXg;
     float posYg;
+    bool frightened;
 
 public:
     // Ghost constructor to set initial position to 0
-    Ghost() : positionXg(0.0), positionYg(0.0) {}
+    Ghost() : positionXg(0.0), positionYg(0.0), frightened(false) {}
 
     void draw(float posX, float posY);
 
+    // Draw the ghost in blue while Pacman can eat it
+    void frighten(bool isFrightened) { frightened = isFrightened; }
+
     float getPosXg() const { return positionXg.load(); }
     float getPosYg() const { return positionYg.load(); }
 
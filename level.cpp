@@ -0,0 +1,206 @@
+#include "level.h"
+
+#include <fstream>
+#include <sstream>
+
+// The maze the game shipped with
+static const char* builtinMaze =
+    "###############\n"
+    "#P....###....o#\n"
+    "#.#.#..#..#.#.#\n"
+    "#.#.##.#.##.#.#\n"
+    "#.#..#.#.#..#.#\n"
+    "#.##...o...##.#\n"
+    "#....##.##....#\n"
+    "#.##.#.G.#.##.#\n"
+    "#.#..#####..#.#\n"
+    "#...###.###...#\n"
+    "#.#.#.....#.#.#\n"
+    "#.#.. #B#...#.#\n"
+    "#.##.##.##.##.#\n"
+    "#o...........o#\n"
+    "###############\n";
+
+Level::Level() : rows(0), cols(0), pellets(), pelletCount(0), powerPelletCells(), powerPelletCount(0),
+                 pacmanStart(-1), ghostHome(-1), bonusCell(-1) {}
+
+std::shared_ptr<const Level> Level::builtin() {
+    // Built once and kept for the whole run, so callers may hold plain pointers to it
+    static const std::shared_ptr<const Level> level = [] {
+        std::string error;
+        return parse(builtinMaze, error);
+    }();
+    return level;
+}
+
+std::shared_ptr<const Level> Level::loadFile(const std::string& path, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open " + path;
+        return nullptr;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    return parse(text.str(), error);
+}
+
+std::shared_ptr<const Level> Level::parse(const std::string& text, std::string& error) {
+    // Split into rows, ignoring a trailing carriage return and blank lines at the end
+    std::vector<std::string> lines;
+    std::stringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+        lines.push_back(line);
+    }
+    while (!lines.empty() && lines.back().empty()) { lines.pop_back(); }
+
+    if (lines.size() < 3 || lines.size() > (size_t)kMaxRows) {
+        error = "a level needs between 3 and " + std::to_string(kMaxRows) + " rows";
+        return nullptr;
+    }
+    size_t width = lines[0].size();
+    if (width < 3 || width > (size_t)kMaxCols) {
+        error = "a level needs between 3 and " + std::to_string(kMaxCols) + " columns";
+        return nullptr;
+    }
+
+    std::shared_ptr<Level> level(new Level());
+    level->rows = (int)lines.size();
+    level->cols = (int)width;
+    level->walls.assign(level->getCells(), 0);
+
+    for (int row = 0; row < level->rows; row++) {
+        if (lines[row].size() != width) {
+            error = "row " + std::to_string(row + 1) + " has a different length";
+            return nullptr;
+        }
+        for (int col = 0; col < level->cols; col++) {
+            int cell = row * level->cols + col;
+            char c = lines[row][col];
+            bool border = row == 0 || col == 0 || row == level->rows - 1 || col == level->cols - 1;
+            if (border && c != '#') {
+                error = "the border must be wall at row " + std::to_string(row + 1) + ", column " + std::to_string(col + 1);
+                return nullptr;
+            }
+
+            switch (c) {
+                case '#':
+                    level->walls[cell] = 1;
+                    continue;
+                case ' ':
+                    continue;
+                case '.':
+                    break;
+                case 'o':
+                    if (level->powerPelletCount == kMaxPowerPellets) {
+                        error = "at most " + std::to_string(kMaxPowerPellets) + " power pellets are allowed";
+                        return nullptr;
+                    }
+                    level->powerPelletCells[level->powerPelletCount++] = cell;
+                    break;
+                case 'P':
+                case 'G':
+                case 'B': {
+                    int& marker = c == 'P' ? level->pacmanStart : (c == 'G' ? level->ghostHome : level->bonusCell);
+                    if (marker >= 0) {
+                        error = std::string("more than one '") + c + "'";
+                        return nullptr;
+                    }
+                    marker = cell;
+                    break;
+                }
+                default:
+                    error = std::string("unknown character '") + c + "' at row " + std::to_string(row + 1);
+                    return nullptr;
+            }
+
+            // Every non-wall cell other than ' ' holds a pellet
+            level->pellets[cell >> 6] |= 1ull << (cell & 63);
+            level->pelletCount++;
+        }
+    }
+
+    if (level->pacmanStart < 0 || level->ghostHome < 0) {
+        error = "a level needs one 'P' and one 'G'";
+        return nullptr;
+    }
+
+    level->mergeWalls();
+    level->computeDistances();
+
+    // Every pellet must be reachable, or the level could never be won
+    for (int cell = 0; cell < level->getCells(); cell++) {
+        bool pellet = (level->pellets[cell >> 6] >> (cell & 63)) & 1;
+        if (pellet && level->distance(level->pacmanStart, cell) == kUnreachable) {
+            error = "the pellet at row " + std::to_string(cell / level->cols + 1) + ", column " +
+                    std::to_string(cell % level->cols + 1) + " cannot be reached";
+            return nullptr;
+        }
+    }
+    return level;
+}
+
+bool Level::isPowerPellet(int cell) const {
+    for (int i = 0; i < powerPelletCount; i++) {
+        if (powerPelletCells[i] == cell) { return true; }
+    }
+    return false;
+}
+
+void Level::mergeWalls() {
+    // Greedy merge: grow each unused wall cell right as far as possible,
+    // then down while the whole span below is unused wall
+    std::vector<uint8_t> used(getCells(), 0);
+    wallRects.clear();
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            int cell = row * cols + col;
+            if (!walls[cell] || used[cell]) { continue; }
+
+            int right = col + 1;
+            while (right < cols && walls[row * cols + right] && !used[row * cols + right]) { right++; }
+
+            int bottom = row + 1;
+            for (; bottom < rows; bottom++) {
+                bool spanIsWall = true;
+                for (int x = col; x < right && spanIsWall; x++) {
+                    spanIsWall = walls[bottom * cols + x] && !used[bottom * cols + x];
+                }
+                if (!spanIsWall) { break; }
+            }
+
+            for (int y = row; y < bottom; y++) {
+                for (int x = col; x < right; x++) { used[y * cols + x] = 1; }
+            }
+            wallRects.push_back({ (int16_t)col, (int16_t)row, (int16_t)right, (int16_t)bottom });
+        }
+    }
+}
+
+void Level::computeDistances() {
+    // Breadth-first search from every floor cell
+    int cells = getCells();
+    distances.assign((size_t)cells * cells, kUnreachable);
+    std::vector<int> queue(cells);
+    const int steps[4] = { -1, 1, -cols, cols };
+
+    for (int from = 0; from < cells; from++) {
+        if (walls[from]) { continue; }
+        uint16_t* row = &distances[(size_t)from * cells];
+        int head = 0;
+        int tail = 0;
+        row[from] = 0;
+        queue[tail++] = from;
+        while (head < tail) {
+            int cell = queue[head++];
+            for (int step : steps) {
+                // The border is solid wall, so a floor cell's neighbours are always inside the grid
+                int next = cell + step;
+                if (walls[next] || row[next] != kUnreachable) { continue; }
+                row[next] = row[cell] + 1;
+                queue[tail++] = next;
+            }
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A wall rectangle in cells, covering [left, right) x [top, bottom)
+struct WallRect {
+    int16_t left;
+    int16_t top;
+    int16_t right;
+    int16_t bottom;
+};
+
+// A maze baked for play: collision grid, starting pellets, merged wall
+// geometry for drawing and maze distances between every pair of cells,
+// used by the Pacman bot to find the nearest pellet
+// A Level never changes once built, so any thread may read it
+//
+// Text format, one line per row, every row the same length:
+//   '#' wall   '.' pellet   'o' power pellet   ' ' empty floor
+//   'P' Pacman start   'G' ghost home   'B' bonus item (all three also hold a pellet)
+// The outer border must be wall and every pellet must be reachable from 'P'
+class Level {
+public:
+    static constexpr int kMaxRows = 64;
+    static constexpr int kMaxCols = 64;
+    static constexpr int kMaxCells = kMaxRows * kMaxCols;
+    static constexpr int kMaxPelletWords = kMaxCells / 64;
+    static constexpr int kMaxPowerPellets = 8;
+    static constexpr uint16_t kUnreachable = 0xFFFF;
+
+    // Method to return the maze the game shipped with
+    static std::shared_ptr<const Level> builtin();
+
+    // Methods to build a level from text or a file, returning nullptr and a reason when it is invalid
+    static std::shared_ptr<const Level> parse(const std::string& text, std::string& error);
+    static std::shared_ptr<const Level> loadFile(const std::string& path, std::string& error);
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    int getCells() const { return rows * cols; }
+
+    bool isWall(int col, int row) const { return walls[row * cols + col]; }
+    bool isWall(int cell) const { return walls[cell]; }
+
+    // Starting pellets, bit i is cell i in row-major order
+    const uint64_t* getPelletWords() const { return pellets; }
+    int getPelletCount() const { return pelletCount; }
+
+    // 64-bit words of the pellet set this maze uses, the rest are always zero
+    int getPelletWordCount() const { return (getCells() + 63) / 64; }
+
+    bool isPowerPellet(int cell) const;
+    int getPowerPelletCount() const { return powerPelletCount; }
+    int getPowerPelletCell(int i) const { return powerPelletCells[i]; }
+
+    int getPacmanStart() const { return pacmanStart; }
+    int getGhostHome() const { return ghostHome; }
+    bool hasBonus() const { return bonusCell >= 0; }
+    int getBonusCell() const { return bonusCell; }
+
+    // Walls merged into as few rectangles as possible
+    const std::vector<WallRect>& getWallRects() const { return wallRects; }
+
+    // Steps along the maze between two cells, kUnreachable through walls
+    uint16_t distance(int fromCell, int toCell) const { return distances[(size_t)fromCell * getCells() + toCell]; }
+
+private:
+    int rows;
+    int cols;
+    std::vector<uint8_t> walls;
+    uint64_t pellets[kMaxPelletWords];
+    int pelletCount;
+    int powerPelletCells[kMaxPowerPellets];
+    int powerPelletCount;
+    int pacmanStart;
+    int ghostHome;
+    int bonusCell;
+    std::vector<WallRect> wallRects;
+    std::vector<uint16_t> distances;
+
+    Level();
+
+    // Methods to precompute the wall rectangles and the distance table
+    void mergeWalls();
+    void computeDistances();
+};
+
+#endif // LEVEL_H
@@ -0,0 +1,118 @@
+#include "levelmanager.h"
+
+#include <chrono>
+#include <iostream>
+
+// Method to load one level, an empty path being the built-in maze
+static std::shared_ptr<const Level> loadLevel(const std::string& path, std::string& error) {
+    return path.empty() ? Level::builtin() : Level::loadFile(path, error);
+}
+
+LevelManager::LevelManager(const std::vector<std::string>& levelPaths)
+    : paths(levelPaths), index(0), stagedBakeMillis(0), requested(0), requestPending(false), stopping(false),
+      ready(false), lastBakeMillis(0), lastHandoffMicros(0) {
+    if (paths.empty()) { paths.push_back(""); }
+
+    // The first level is needed before anything can be drawn, so it is loaded right here
+    std::string error;
+    current = loadLevel(paths[0], error);
+    if (!current) {
+        std::cerr << "Level " << paths[0] << ": " << error << ", using the built-in maze" << std::endl;
+        current = Level::builtin();
+    }
+
+    worker = std::thread(&LevelManager::workerLoop, this);
+    if (paths.size() > 1) { preload(1); }
+}
+
+LevelManager::~LevelManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void LevelManager::preload(size_t levelIndex, std::shared_ptr<const Level> oldLevel) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        retired = std::move(oldLevel);
+        requested = levelIndex;
+        requestPending = true;
+        staged.reset();
+        ready.store(false, std::memory_order_relaxed);
+    }
+    wake.notify_one();
+}
+
+void LevelManager::workerLoop() {
+    for (;;) {
+        std::shared_ptr<const Level> old;
+        std::string path;
+        bool load;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || retired || (requestPending && !staged && stagedError.empty()); });
+            if (stopping) { return; }
+            old = std::move(retired);
+            load = requestPending && !staged && stagedError.empty();
+            if (load) { path = paths[requested]; }
+        }
+
+        // A level replaced by advance() is freed here, so the game thread never pays for its tables
+        old.reset();
+        if (!load) { continue; }
+
+        // Parsing, validation, wall merging and the distance table all happen off the game thread
+        auto start = std::chrono::steady_clock::now();
+        std::string error;
+        std::shared_ptr<const Level> level = loadLevel(path, error);
+        double millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            staged = level;
+            stagedError = level ? "" : (error.empty() ? "unknown error" : error);
+            requestPending = false;
+            stagedBakeMillis = millis;
+            ready.store(level != nullptr, std::memory_order_release);
+        }
+        loaded.notify_all();
+    }
+}
+
+bool LevelManager::advance() {
+    if (paths.size() < 2) { return false; }
+
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const Level> next;
+    std::string error;
+    size_t nextIndex;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        loaded.wait(lock, [&] { return !requestPending; });
+        next = std::move(staged);
+        error = stagedError;
+        stagedError.clear();
+        nextIndex = requested;
+        lastBakeMillis = stagedBakeMillis;
+        ready.store(false, std::memory_order_relaxed);
+    }
+
+    // A level that failed to load is skipped: the current one stays, and so does its index
+    if (next) {
+        current.swap(next);
+        index = nextIndex;
+    }
+
+    // Hand the old level to the worker to free and start on the level after the one just tried
+    preload((nextIndex + 1) % paths.size(), std::move(next));
+    lastHandoffMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    if (!error.empty()) {
+        std::cerr << "Level " << paths[nextIndex] << ": " << error << ", skipped" << std::endl;
+        return false;
+    }
+    return true;
+}
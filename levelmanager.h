@@ -0,0 +1,69 @@
+#ifndef LEVELMANAGER_H
+#define LEVELMANAGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "level.h"
+
+// Plays a list of levels in order, loading and baking the next one on a
+// worker thread while the current one is being played
+// Only advance() touches the game thread, and when the preload has
+// finished it is just a pointer swap
+class LevelManager {
+private:
+    std::vector<std::string> paths;
+    size_t index;
+    std::shared_ptr<const Level> current;
+
+    // Handoff between the worker and the game thread, guarded by mutex
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable loaded;
+    std::shared_ptr<const Level> staged;
+    std::shared_ptr<const Level> retired; // replaced level, left for the worker to free
+    std::string stagedError;
+    double stagedBakeMillis;
+    size_t requested;
+    bool requestPending;
+    bool stopping;
+    std::atomic<bool> ready;
+
+    double lastBakeMillis;
+    double lastHandoffMicros;
+
+    void workerLoop();
+    // Method to ask the worker for a level, and to free oldLevel if one is given
+    void preload(size_t levelIndex, std::shared_ptr<const Level> oldLevel = nullptr);
+
+public:
+    // LevelManager constructor, an empty path stands for the built-in maze
+    explicit LevelManager(const std::vector<std::string>& levelPaths);
+    ~LevelManager();
+
+    LevelManager(const LevelManager&) = delete;
+    LevelManager& operator=(const LevelManager&) = delete;
+
+    const Level* getCurrent() const { return current.get(); }
+    size_t getIndex() const { return index; }
+    size_t getCount() const { return paths.size(); }
+
+    // Method to tell whether the next level has been baked and can be swapped in at once
+    bool isNextReady() const { return ready.load(std::memory_order_acquire); }
+
+    // Method to switch to the next level, waiting for the worker only if it is not done yet
+    // A level that fails to load is reported and skipped, so the current one is kept
+    // Returns true if a new level is in place
+    bool advance();
+
+    // How long the worker spent loading and baking the last level, and how long advance() took
+    double getLastBakeMillis() const { return lastBakeMillis; }
+    double getLastHandoffMicros() const { return lastHandoffMicros; }
+};
+
+#endif // LEVELMANAGER_H
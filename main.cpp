@@ -4,6 +4,11 @@
 #include "game.h"
 #include "pacman.h"
 #include "ghost.h"
+#include "mcts.h"
+#include "allocstats.h"
+#include "broadcast.h"
+#include "levelmanager.h"
+#include "metrics.h"
 
 // Define constants for arrow key codes
 #define LEFT_ARROW 37
@@ -11,11 +16,26 @@
 #define RIGHT_ARROW 39
 #define DOWN_ARROW 40
 
+// Scratch memory for data that only lives during one frame
+#define FRAME_ARENA_BYTES (64 * 1024)
+
+// Frames to skip before a frame that allocates is reported
+#define WARMUP_FRAMES 120
+
+// One refresh of a 60 Hz display; a longer gap between frames counts the refreshes missed as dropped frames
+#define FRAME_BUDGET_MICROS 16667
+
 // Include OpenGL headers
+#ifdef __APPLE__
 #include <OpenGL/gl.h>
 #include <GLUT/glut.h>
+#else
+#include <GL/gl.h>
+#include <GL/glut.h>
+#endif
 
 // Include other necessary standard libraries
+#include <cstdio>
 #include <iostream>
 #include <vector>
 #include <deque>
@@ -24,6 +44,7 @@
 #include <string>
 #include <memory>
 #include <cmath>
+#include <algorithm>
 
 using namespace std;
 
@@ -81,8 +102,9 @@ void Ghost::draw(float posXg, float posYg) {
     int x, y;
     glBegin(GL_LINES);
 
-    // Set the ghost's color to light pink
-    glColor3f(1.0, 0.50, 0.75);
+    // Set the ghost's color to light pink, or blue while frightened
+    if (frightened) { glColor3f(0.2, 0.3, 1.0); }
+    else { glColor3f(1.0, 0.50, 0.75); }
     
     // Draw the head of the ghost
     for (int k = 0; k < 32; k++) {
@@ -118,27 +140,10 @@ void Ghost::draw(float posXg, float posYg) {
 
 
 // ** GAME **
-Game::Game(Pacman& p, Ghost& g) : pacman(p), ghost(g), replay(false), over(true), squareSize(50.0), xIncrementp(0), yIncrementp(0), xIncrementg(1.5), yIncrementg(1.5), rotation(0), points(0) { 
+Game::Game(Pacman& p, Ghost& g) : pacman(p), ghost(g), replay(false), over(true), squareSize(50.0), rotation(0), pacmanBot(nullptr), ghostBot(nullptr), broadcaster(nullptr), levels(nullptr), frameArena(FRAME_ARENA_BYTES), frameCount(0) { 
 
         // Dynamically allocate the array to store key states
         keyStates.resize(256);
-
-        // Define the bitmap (game board layout) using a 2D array initialization
-        bitmap1 = { { 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 },
-                    { 1,0,0,0,0,0,1,1,1,0,0,0,0,0,1 },
-                    { 1,0,1,0,1,0,0,1,0,0,1,0,1,0,1 },
-                    { 1,0,1,0,1,1,0,1,0,1,1,0,1,0,1 },
-                    { 1,0,1,0,0,1,0,1,0,1,0,0,1,0,1 },
-                    { 1,0,1,1,0,0,0,0,0,0,0,1,1,0,1 },
-                    { 1,0,0,0,0,1,1,0,1,1,0,0,0,0,1 },
-                    { 1,0,1,1,0,1,0,0,0,1,0,1,1,0,1 },
-                    { 1,0,1,0,0,1,1,1,1,1,0,0,1,0,1 },
-                    { 1,0,0,0,1,1,1,0,1,1,1,0,0,0,1 },
-                    { 1,0,1,0,1,0,0,0,0,0,1,0,1,0,1 },
-                    { 1,0,1,0,0,0,1,0,1,0,0,0,1,0,1 },
-                    { 1,0,1,1,0,1,1,0,1,1,0,1,1,0,1 },
-                    { 1,0,0,0,0,0,0,0,0,0,0,0,0,0,1 },
-                    { 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1 } };
 }
 
 // Destructor for cleaning up resources allocated by the Game object
@@ -158,27 +163,34 @@ void Game::init() {
     for (int i = 0; i < 256; i++) { keyStates[i] = false; }    
 }
 
-// Draw the labyrinth based on the bitmap representation
+// Let MCTS bots play instead of the keyboard, nullptr keeps a side on the keyboard
+void Game::setBots(MctsBot* pacmanPlayer, MctsBot* ghostPlayer) {
+    pacmanBot = pacmanPlayer;
+    ghostBot = ghostPlayer;
+}
+
+// Publish every simulated tick to spectator processes, nullptr stops publishing
+void Game::setBroadcaster(Broadcaster* spectators) { broadcaster = spectators; }
+
+// Play the levels of a level manager in turn, moving on after each win
+void Game::setLevels(LevelManager* levelList) {
+    levels = levelList;
+    if (levels) { core.setLevel(levels->getCurrent()); }
+    publishGauges();
+}
+
+// Method to update the score, pellet and level gauges of the metrics registry
+void Game::publishGauges() {
+    metricsSet(METRIC_SCORE, core.getScore());
+    metricsSet(METRIC_PELLETS_LEFT, core.getLevel().getPelletCount() - core.getPoints());
+    metricsSet(METRIC_LEVEL, levels ? (int64_t)levels->getIndex() + 1 : 1);
+}
+
+// Draw the labyrinth from the wall rectangles the level merged when it was baked
 void Game::drawLaberynth() {
-    // Iterate through each row (y-axis) of the bitmap
-    for (int y = 0; y < bitmap1.size(); ++y) {
-
-        // Iterate through each column (x-axis) of the bitmap
-        for (int x = 0; x < bitmap1[y].size(); ++x) {
-
-            // Check if the current cell in the bitmap represents an obstacle (value 1)
-            if (bitmap1[y][x] == 1) {
-                // Calculate the coordinates of the rectangle to fill
-                float left = x * squareSize;
-                float bottom = y * squareSize;
-                float right = (x + 1) * squareSize;
-                float top = (y + 1) * squareSize;
-
-                // Draw a filled rectangle for the obstacle
-                glColor3f(0.0, 0.0, 0.0); 
-                glRectf(left, bottom, right, top);
-            }
-        }
+    glColor3f(0.0, 0.0, 0.0);
+    for (const WallRect& wall : core.getLevel().getWallRects()) {
+        glRectf(wall.left * squareSize, wall.top * squareSize, wall.right * squareSize, wall.bottom * squareSize);
     }
 
     // Draw the border of the labyrinth
@@ -189,150 +201,90 @@ void Game::drawLaberynth() {
     }
 }
 
-// Method to check if the food has been eaten
-bool Game::foodEaten(int x, int y, float pacmanX, float pacmanY) {
-    float radius = 16.0 * cos(359 * M_PI / 180.0);
-
-    // Check if the food is within the radius of Pacman's mouth
-    return (x >= pacmanX - radius && x <= pacmanX + radius) &&
-        (y >= pacmanY - radius && y <= pacmanY + radius);
-}
-
-// Method to draw all remaining food items and delete the eaten ones
-void Game::drawFood(float pacmanX, float pacmanY) {
-    vector<float> temp;
-
-    // Iterate through each food position
-    for (size_t i = 0; i < foodPositions.size(); i += 2) {
-
-        // Check if the current food position is not eaten
-        if (!foodEaten(foodPositions[i] * squareSize, foodPositions[i + 1] * squareSize, pacmanX, pacmanY)) {
-            temp.push_back(foodPositions[i]);
-            temp.push_back(foodPositions[i + 1]);
-        }
-        else {
-            // If eaten, increase the player's points counter
-            points++;
-        }
-    }
+// Method to draw all remaining food items
+void Game::drawFood() {
+    // Gather the remaining food items into one vertex batch in the frame arena,
+    // pellets from the front and power pellets from the back
+    int capacity = core.getLevel().getPelletCount();
+    float* vertices = frameArena.createArray<float>(2 * capacity);
+    if (!vertices) { return; }
 
-    // Update the foodPositions vector with the remaining uneaten food positions
-    foodPositions = std::move(temp);
+    int powerCount;
+    int count = core.fillPelletVertices(vertices, squareSize, powerCount);
 
     // Draw remaining food items as white points on the screen
-    glPointSize(5.0);
-    glBegin(GL_POINTS);
     glColor3f(1.0, 1.0, 1.0); // Set color to white for pellets
-    
-    for (size_t j = 0; j < foodPositions.size(); j += 2) {
-        glVertex2f(foodPositions[j] * squareSize, foodPositions[j + 1] * squareSize);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, vertices);
+    glPointSize(5.0);
+    glDrawArrays(GL_POINTS, 0, count);
+    glPointSize(12.0);
+    glDrawArrays(GL_POINTS, capacity - powerCount, powerCount);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    // Draw the bonus item as a red square while it is on the board
+    if (core.isBonusActive()) {
+        int bonusCell = core.getLevel().getBonusCell();
+        float bonusX = (bonusCell % core.getCols() + 0.5) * squareSize;
+        float bonusY = (bonusCell / core.getCols() + 0.5) * squareSize;
+        glColor3f(1.0, 0.0, 0.0);
+        glRectf(bonusX - 8, bonusY - 8, bonusX + 8, bonusY + 8);
     }
-    
-    glEnd();
 }
 
 // Method to reset the game state, initializing game parameters for a new game
 void Game::resetGame() {
     over = false;
-    xIncrementp = 0;
-    yIncrementp = 0;
-    xIncrementg = 1.5;
-    yIncrementg = 1.5; 
     rotation = 0;
-    points = 0;
 
     // Reset key states
     for (int i = 0; i < 256; i++){
         keyStates[i] = false;
     }
     
-    // Reset food positions
-    foodPositions = { 
-        1.5, 1.5, 1.5, 2.5, 1.5, 3.5, 1.5, 4.5, 
-        1.5, 5.5, 1.5, 6.5, 1.5, 7.5, 1.5, 8.5, 
-        1.5, 9.5, 1.5, 10.5, 1.5, 11.5, 1.5, 12.5, 
-        1.5, 13.5, 2.5, 1.5, 2.5, 6.5, 2.5, 9.5, 
-        2.5, 13.5, 3.5, 1.5, 3.5, 2.5, 3.5, 3.5, 
-        3.5, 4.5, 3.5, 6.5, 3.5, 8.5, 3.5, 9.5, 
-        3.5, 10.5, 3.5, 11.5, 3.5, 13.5, 4.5, 1.5, 
-        4.5, 4.5, 4.5, 5.5, 4.5, 6.5, 4.5, 7.5, 
-        4.5, 8.5, 4.5, 11.5, 4.5, 12.5, 4.5, 13.5, 
-        5.5, 1.5, 5.5, 2.5, 5.5, 5.5, 5.5, 10.5, 
-        5.5, 13.5, 6.5, 2.5, 6.5, 3.5, 6.5, 4.5, 
-        6.5, 5.5, 6.5, 7.5, 6.5, 10.5, 6.5, 13.5, 
-        7.5, 5.5, 7.5, 6.5, 7.5, 7.5, 7.5, 9.5, 
-        7.5, 10.5, 7.5, 11.5, 7.5, 12.5, 7.5, 13.5, 
-        8.5, 2.5, 8.5, 3.5, 8.5, 4.5, 8.5, 5.5, 
-        8.5, 7.5, 8.5, 10.5, 8.5, 13.5, 9.5, 1.5, 
-        9.5, 2.5, 9.5, 5.5, 9.5, 10.5, 9.5, 11.5, 
-        9.5, 13.5, 10.5, 1.5, 10.5, 4.5, 10.5, 5.5, 
-        10.5, 6.5, 10.5, 7.5, 10.5, 8.5, 10.5, 11.5, 
-        10.5, 12.5, 10.5, 13.5, 11.5, 1.5, 11.5, 2.5, 
-        11.5, 3.5, 11.5, 4.5, 11.5, 6.5, 11.5, 8.5, 
-        11.5, 9.5, 11.5, 10.5, 11.5, 11.5, 11.5, 13.5, 
-        12.5, 1.5, 12.5, 6.5, 12.5, 9.5, 12.5, 13.5, 
-        13.5, 1.5, 13.5, 2.5, 13.5, 3.5, 13.5, 4.5, 
-        13.5, 5.5, 13.5, 6.5, 13.5, 7.5, 13.5, 8.5, 
-        13.5, 9.5, 13.5, 10.5, 13.5, 11.5, 13.5, 12.5, 13.5, 13.5 
-    };
+    // After a win the next level takes over, already baked by the level manager's worker
+    if (levels && core.isWon() && levels->advance()) {
+        core.setLevel(levels->getCurrent());
+        cout << "Level " << levels->getIndex() + 1 << " of " << levels->getCount()
+             << ": handoff " << levels->getLastHandoffMicros() << " us, baked in "
+             << levels->getLastBakeMillis() << " ms" << endl;
+    }
+
+    // Reset positions, points and food
+    core.reset();
+    publishGauges();
+    if (pacmanBot) { pacmanBot->restart(); }
+    if (ghostBot) { ghostBot->restart(); }
 }
     
 // Method to update the movement of the pacman according to the movement keys pressed
 void Game::keyOperations() {
 
-    x_p = (1.5 + xIncrementp) * squareSize;
-    y_p = (1.5 + yIncrementp) * squareSize;
-
     // Update Pacman's movement according to keys pressed
-    
-    if (keyStates['a']) {
-        x_p -= 2;
-        int x1Quadrant = (int)((x_p - 16.0 * cos(360 * M_PI / 180.0)) / squareSize);
-        if (!this->bitmap1[(int)y_p / squareSize][x1Quadrant]) {
-            xIncrementp -= 2 / squareSize;
-            pacman.rotate(2);
-        }
-    }
-    
-    if (keyStates['d']) {
-        x_p += 2;
-        int x2Quadrant = (int)((x_p + 16.0 * cos(360 * M_PI / 180.0)) / squareSize);
-        if (!this->bitmap1[(int)y_p / squareSize][x2Quadrant]) {
-            xIncrementp += 2 / squareSize;
-            pacman.rotate(0);
-        }
-    }
-    
-    if (keyStates['w']) {
-        y_p -= 2;
-        int y1Quadrant = (int)((y_p - 16.0 * cos(360 * M_PI / 180.0)) / squareSize);
-        if (!this->bitmap1[y1Quadrant][(int)x_p / squareSize]) {
-            yIncrementp -= 2 / squareSize;
-            pacman.rotate(3);
-        }
-    }
-    
-    if (keyStates['s']) {
-        y_p += 2;
-        int y2Quadrant = (int)((y_p + 16.0 * cos(360 * M_PI / 180.0)) / squareSize);
-        if (!this->bitmap1[y2Quadrant][(int)x_p / squareSize]) {
-            yIncrementp += 2 / squareSize;
-            pacman.rotate(1);
-        }
-    }
+    uint8_t pacmanMoves = MOVE_NONE;
+    if (keyStates['a']) { pacmanMoves |= MOVE_LEFT; }
+    if (keyStates['d']) { pacmanMoves |= MOVE_RIGHT; }
+    if (keyStates['w']) { pacmanMoves |= MOVE_UP; }
+    if (keyStates['s']) { pacmanMoves |= MOVE_DOWN; }
 
     // Update Ghost's movement according to keys pressed
-    
-    x_g = (1.5 + xIncrementg  + (7.5*squareSize));
-    y_g = (1.5 + yIncrementg  + (7.5*squareSize));
-
-    if (keyStates[LEFT_ARROW]) { xIncrementg -= 1.5 ; }
-    
-    if (keyStates[RIGHT_ARROW]) { xIncrementg += 1.5 ; }
-        
-    if (keyStates[UP_ARROW]) { yIncrementg -= 1.5 ; }
-    
-    if (keyStates[DOWN_ARROW]) { yIncrementg += 1.5 ; }
+    uint8_t ghostMoves = MOVE_NONE;
+    if (keyStates[LEFT_ARROW]) { ghostMoves |= MOVE_LEFT; }
+    if (keyStates[RIGHT_ARROW]) { ghostMoves |= MOVE_RIGHT; }
+    if (keyStates[UP_ARROW]) { ghostMoves |= MOVE_UP; }
+    if (keyStates[DOWN_ARROW]) { ghostMoves |= MOVE_DOWN; }
+
+    // Advance the simulation by one tick while a game is running, bots replace the keys
+    if (replay && !over) {
+        if (pacmanBot) { pacmanMoves = pacmanBot->nextMove(core); }
+        if (ghostBot) { ghostMoves = ghostBot->nextMove(core); }
+        int eaten = core.step(pacmanMoves, ghostMoves);
+        pacman.rotate(core.getRotation());
+        if (broadcaster) { broadcaster->publish(core, replay); }
+        metricsAdd(METRIC_TICKS);
+        if (eaten > 0) { metricsAdd(METRIC_POINTS, eaten); }
+        publishGauges();
+    }
 
     if (keyStates[' ']) {
         // Reset the game if replaying and game over
@@ -357,37 +309,15 @@ void Game::keyOperations() {
 
 // Method to check if the game is over
 void Game::gameOver() {
-    cout << x_p << ','<< y_p << ','  << x_g << ',' << y_g<< endl;
-    // x_p = x_p/squareSize;
-    // y_p = y_p/squareSize;
-
-    int numberx = x_g; // The number you want to check
-    int lowerBoundx = x_p - 10; // Lower bound of the range
-    int upperBoundx = x_p + 10;
-
-    int numbery = y_g; // The number you want to check
-    int lowerBoundy = y_p - 10; // Lower bound of the range
-    int upperBoundy = y_p + 10;
-
-    if (numberx >= lowerBoundx && numberx <= upperBoundx) 
-    {
-        if (numbery >= lowerBoundy && numbery <= upperBoundy)
-        {
-            cout << "Number is between the bounds." << endl;
-            over = true;
-            return;
-        }
-    } 
-    else {
-    cout << "Number is outside the bounds." << endl;
-    }
-
-    // Check if all food (105 points) is eaten
-    if (points == 105) {
+    // The core ends the game once the ghost catches Pacman or all food is eaten
+    if (core.isOver() && !over) {
         over = true;
-        return;
-    }
+        metricsAdd(core.isWon() ? METRIC_GAMES_WON : METRIC_GAMES_LOST);
 
+        // Report how hard the bots searched during the game
+        if (pacmanBot) { cout << "Pacman bot: " << (long)(pacmanBot->getTotalPlayouts() / pacmanBot->getTotalSearchSeconds()) << " playouts/s" << endl; }
+        if (ghostBot) { cout << "Ghost bot: " << (long)(ghostBot->getTotalPlayouts() / ghostBot->getTotalSearchSeconds()) << " playouts/s" << endl; }
+    }
 }
 
 // Method to display the results of the game at the ends
@@ -396,7 +326,7 @@ void Game::resultsDisplay() {
     glClearColor(0, 0, 0, 1.0);
     glClear(GL_COLOR_BUFFER_BIT);
     
-    if (points == 105) {
+    if (core.isWon()) {
         // Display message for winning the game
         const char* message = "*************************************";
         glRasterPos2f(170, 250);
@@ -441,8 +371,9 @@ void Game::resultsDisplay() {
         while (*message)
             glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, *message++);
         
-        string result = to_string(points);
-        message = (char*)result.c_str();
+        char result[16];
+        snprintf(result, sizeof(result), "%d", core.getPoints());
+        message = result;
         glRasterPos2f(350, 400);
         while (*message)
             glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, *message++);
@@ -504,9 +435,21 @@ void Game::welcomeScreen() {
 
 // Method to display the screen and its elements
 void Game::display() {
-    // If the game has just started with 1 point, set over to false
-    if (this->points ==1) { this->over = false; }
-    
+    // Everything allocated from the frame arena during the last frame is released here
+    uint64_t allocationsBefore = allocationCount();
+    frameArena.reset();
+
+    // Frame time is measured from one frame's start to the next
+    auto frameStart = std::chrono::steady_clock::now();
+    if (frameCount > 0) {
+        uint32_t micros = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(frameStart - lastFrameStart).count();
+        metricsObserveFrame(micros);
+
+        // Every refresh that went by after the first one without a new frame was dropped
+        if (micros > FRAME_BUDGET_MICROS) { metricsAdd(METRIC_DROPPED_FRAMES, (micros - 1) / FRAME_BUDGET_MICROS); }
+    }
+    lastFrameStart = frameStart;
+
     this->keyOperations();
     glClear(GL_COLOR_BUFFER_BIT);
     this->gameOver();
@@ -514,18 +457,30 @@ void Game::display() {
     // If the player is replaying and the game is over, draw the labyrinth
     if (this->replay) {
         if (!this->over) {
+            this->setView(this->core.getCols() * this->squareSize, this->core.getRows() * this->squareSize);
             this->drawLaberynth();
-            this->drawFood((1.5 + this->xIncrementp) * this->squareSize, (1.5 + this->yIncrementp) * this->squareSize);
-            this->pacman.draw(1.5 + this->xIncrementp, 1.5 + this->yIncrementp, this->rotation);
-            this->ghost.draw(1.5 + this->xIncrementg, 1.5 + this->yIncrementg);
+            this->drawFood();
+            this->pacman.draw(this->core.getPacmanX(), this->core.getPacmanY(), this->rotation);
+            this->ghost.frighten(this->core.getGhostState() == GHOST_FRIGHTENED);
+            this->ghost.draw(this->core.getGhostX(), this->core.getGhostY());
 
         } else {
+            this->setView(750, 750);
             this->resultsDisplay();
         }
     } else {
+        this->setView(750, 750);
         this->welcomeScreen();
     }
     glutSwapBuffers();
+
+    // Once warmed up, a frame should never touch the heap
+    frameCount++;
+    metricsAdd(METRIC_FRAMES);
+    uint64_t frameAllocations = allocationCount() - allocationsBefore;
+    if (allocationCountingEnabled() && frameCount > WARMUP_FRAMES && frameAllocations > 0) {
+        cerr << "Frame " << frameCount << " made " << frameAllocations << " heap allocations" << endl;
+    }
 }
 
 // Method to reshape the game if the screen size changes
@@ -538,6 +493,14 @@ void Game::reshape(int w, int h) {
     glLoadIdentity();
 }
 
+// Method to fit width x height pixels of the game onto the window, so larger mazes shrink to fit
+void Game::setView(float width, float height) {
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0, width, height, 0, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+}
+
 // Declare the game object globally
 
 // Create unique pointers for Pacman and Ghost objects
@@ -548,6 +511,16 @@ float squareSize = 50.0;
         
 Game game(*pacmanPtr, *ghostPtr);
 
+// Optional computer players, enabled from the command line
+std::unique_ptr<MctsBot> pacmanBotPtr;
+std::unique_ptr<MctsBot> ghostBotPtr;
+
+// Optional shared-memory broadcast for spectators
+Broadcaster broadcaster;
+
+// Optional export of the runtime metrics for monitoring tools
+MetricsExporter metricsExporter;
+
 // Define static functions
 
 void displayCallback() { game.display(); }
@@ -555,12 +528,17 @@ void reshapeCallback(int w, int h) { game.reshape(w, h); }
 
 void keyPressedCallback(unsigned char key, int x, int y) {
     std::cout << "Pressed key: " << static_cast<int>(key) << std::endl;
+    metricsAdd(METRIC_INPUT_EVENTS);
     game.keyStates[key] = true;  
 }
 
-void keyUpCallback(unsigned char key, int x, int y){ game.keyStates[key] = false; }
+void keyUpCallback(unsigned char key, int x, int y) {
+    metricsAdd(METRIC_INPUT_EVENTS);
+    game.keyStates[key] = false;
+}
 
 void specialKeyPressedCallback(int key, int x, int y) {
+    metricsAdd(METRIC_INPUT_EVENTS);
     switch (key) {
         case GLUT_KEY_UP:
             game.keyStates[UP_ARROW] = true;
@@ -578,6 +556,7 @@ void specialKeyPressedCallback(int key, int x, int y) {
 }
 
 void specialKeyUpCallback(int key, int x, int y) {
+    metricsAdd(METRIC_INPUT_EVENTS);
     switch (key) {
         case GLUT_KEY_UP:
             game.keyStates[UP_ARROW] = false;
@@ -597,7 +576,44 @@ void specialKeyUpCallback(int key, int x, int y) {
 
 int main(int argc, char** argv) {
 
+    // Only the game thread and its bot helpers are checked for allocations, not the background threads
+    setAllocationCounting(true);
+
     glutInit(&argc, argv);
+
+    // --bot-pacman and --bot-ghost hand a side to the MCTS bot, searching 10 ms per move
+    int botThreads = std::max(1u, std::thread::hardware_concurrency() / 2);
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--bot-pacman") { pacmanBotPtr.reset(new MctsBot(SIDE_PACMAN, botThreads, 10.0)); }
+        if (arg == "--bot-ghost") { ghostBotPtr.reset(new MctsBot(SIDE_GHOST, botThreads, 10.0)); }
+    }
+    game.setBots(pacmanBotPtr.get(), ghostBotPtr.get());
+
+    // --broadcast [name] publishes every tick to POSIX shared memory for pacman_spectator
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) != "--broadcast") { continue; }
+        const char* name = (i + 1 < argc && argv[i + 1][0] == '/') ? argv[i + 1] : "/pacman_broadcast";
+        if (broadcaster.open(name)) {
+            game.setBroadcaster(&broadcaster);
+            cout << "Broadcasting on " << name << endl;
+        }
+    }
+    // --metrics [path] exports the runtime metrics every second to path.prom and path.page
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) != "--metrics") { continue; }
+        string path = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[i + 1] : "pacman_metrics";
+        if (metricsExporter.start(path)) { cout << "Exporting metrics to " << path << ".prom and " << path << ".page" << endl; }
+    }
+
+    // --level file adds a maze to play after the built-in one, levels are played in the order given
+    vector<string> levelPaths(1, "");
+    for (int i = 1; i + 1 < argc; i++) {
+        if (string(argv[i]) == "--level") { levelPaths.push_back(argv[++i]); }
+    }
+    LevelManager levelManager(levelPaths);
+    game.setLevels(&levelManager);
+
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
 
     // Set window size and position
@@ -0,0 +1,278 @@
+#include "mcts.h"
+#include "allocstats.h"
+#include "metrics.h"
+
+#include <cmath>
+
+// Move bits for each action index searched by the tree
+static const uint8_t actionMoves[MctsBot::kActions] = {
+    MOVE_NONE, MOVE_UP, MOVE_DOWN, MOVE_LEFT, MOVE_RIGHT
+};
+
+// Exploration constant of the UCT formula, values lie in [0, 1]
+static const float kExploration = 0.7f;
+
+// Number of playouts between two clock reads
+static const int kClockInterval = 16;
+
+// Maze steps at which being near a pellet is worth half a pellet in the value
+static const float kNearestPelletSteps = 4.0f;
+
+// A searched position, stored in full so a child is a plain copy of its parent
+struct MctsBot::Node {
+    GameCore state;
+    Node* children[kActions];
+    uint32_t visits;
+    float valueSum;
+    uint8_t expanded;
+
+    explicit Node(const GameCore& s) : state(s), children(), visits(0), valueSum(0), expanded(0) {}
+};
+
+// Per-thread search state, reused between moves so the search loop never allocates
+struct MctsBot::Worker {
+    Arena arena;
+    uint64_t rng;
+    uint64_t playouts;
+    uint32_t rootVisits[kActions];
+
+    Worker(size_t arenaBytes, uint64_t seed) : arena(arenaBytes), rng(seed), playouts(0), rootVisits() {}
+};
+
+// xorshift64 random numbers, cheap enough to call every tick of a playout
+static uint32_t nextRandom(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (uint32_t)(state >> 32);
+}
+
+// Method to pick the ghost's move: usually head straight for Pacman (or away while frightened), sometimes wander
+static uint8_t ghostPolicy(const GameCore& s, uint8_t wander, bool chase) {
+    if (!chase) { return wander; }
+    uint8_t moves = MOVE_NONE;
+    int32_t dx = s.getPacmanPosX() - s.getGhostPosX();
+    int32_t dy = s.getPacmanPosY() - s.getGhostPosY();
+    if (s.getGhostState() == GHOST_FRIGHTENED) {
+        dx = -dx;
+        dy = -dy;
+    }
+    if (dx < -GameCore::kGhostSpeed) { moves |= MOVE_LEFT; }
+    if (dx > GameCore::kGhostSpeed) { moves |= MOVE_RIGHT; }
+    if (dy < -GameCore::kGhostSpeed) { moves |= MOVE_UP; }
+    if (dy > GameCore::kGhostSpeed) { moves |= MOVE_DOWN; }
+    return moves;
+}
+
+// Method to play one held action for both sides, the opponent following the default policy
+static void playAction(GameCore& s, Side side, uint8_t ourMove, uint64_t& rng) {
+    uint8_t wander = actionMoves[1 + nextRandom(rng) % 4];
+    bool chase = nextRandom(rng) % 4 != 0;
+    for (int t = 0; t < MctsBot::kTicksPerAction && !s.isOver(); t++) {
+        if (side == SIDE_PACMAN) {
+            s.step(ourMove, ghostPolicy(s, wander, chase));
+        } else {
+            s.step(wander, ourMove);
+        }
+    }
+}
+
+// Method to return the maze distance from Pacman's cell to the nearest pellet left
+static int nearestPelletDistance(const GameCore& s) {
+    const Level& level = s.getLevel();
+    int from = (s.getPacmanPosY() / GameCore::kSubCell) * level.getCols() + s.getPacmanPosX() / GameCore::kSubCell;
+    int nearest = Level::kUnreachable;
+    const uint64_t* words = s.getPelletWords();
+    for (int w = 0; w < s.getPelletWordCount(); w++) {
+        for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+            int d = level.distance(from, w * 64 + __builtin_ctzll(bits));
+            if (d < nearest) { nearest = d; }
+        }
+    }
+    return nearest;
+}
+
+// Method to score a position for Pacman: caught is 0, cleared maze is 1,
+// and a surviving Pacman earns more the more food he ate since the root,
+// plus part of a pellet for being close to the nearest one left, so the
+// search still has a direction when no pellet is within the rollout horizon
+static float pacmanValue(const GameCore& s, int rootPoints) {
+    if (s.isOver()) { return s.isWon() ? 1.0f : 0.0f; }
+    float closeness = kNearestPelletSteps / (kNearestPelletSteps + nearestPelletDistance(s));
+    return 0.5f + 0.5f * (s.getPoints() - rootPoints + closeness) / (s.getLevel().getPelletCount() - rootPoints + 1);
+}
+
+MctsBot::MctsBot(Side side, int numThreads, double moveBudgetMs, size_t arenaBytesPerThread)
+    : side(side), moveBudgetMs(moveBudgetMs), heldMove(MOVE_NONE), ticksLeft(0),
+      lastPlayouts(0), lastPlayoutsPerSecond(0), totalPlayouts(0), totalSearchSeconds(0),
+      generation(0), pending(0), stopping(false), searchRoot(nullptr) {
+    if (numThreads < 1) { numThreads = 1; }
+    workers.reserve(numThreads);
+    for (int i = 0; i < numThreads; i++) {
+        workers.emplace_back(arenaBytesPerThread, 0x9E3779B97F4A7C15ull * (i + 1) + side);
+    }
+
+    // The calling thread searches with worker 0, every other worker gets its own thread
+    // Helpers search for the calling thread, so their allocations are counted if its are
+    bool counted = isAllocationCountingOn();
+    helpers.reserve(numThreads - 1);
+    for (int i = 1; i < numThreads; i++) {
+        helpers.emplace_back([this, &worker = workers[i], counted] {
+            setAllocationCounting(counted);
+            helperLoop(worker);
+        });
+    }
+}
+
+MctsBot::~MctsBot() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    searchStart.notify_all();
+    for (auto& helper : helpers) { helper.join(); }
+}
+
+void MctsBot::helperLoop(Worker& worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        const GameCore* root;
+        std::chrono::steady_clock::time_point deadline;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            searchStart.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) { return; }
+            seen = generation;
+            root = searchRoot;
+            deadline = searchDeadline;
+        }
+
+        search(worker, *root, deadline);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+        }
+        searchDone.notify_one();
+    }
+}
+
+void MctsBot::search(Worker& worker, const GameCore& rootState, std::chrono::steady_clock::time_point deadline) {
+    worker.arena.reset();
+    worker.playouts = 0;
+    for (int a = 0; a < kActions; a++) { worker.rootVisits[a] = 0; }
+
+    Node* root = worker.arena.create<Node>(rootState);
+    if (!root) { return; }
+    int rootPoints = rootState.getPoints();
+
+    // Deepest path a tree can reach is bounded by the game length, cap it anyway
+    Node* path[256];
+
+    for (;;) {
+        if (worker.playouts % kClockInterval == 0 && std::chrono::steady_clock::now() >= deadline) { break; }
+
+        // Selection: follow the best UCT child while every move has been tried
+        Node* node = root;
+        int depth = 0;
+        path[depth++] = node;
+        while (!node->state.isOver() && node->expanded == kActions && depth < 256) {
+            float logVisits = std::log((float)node->visits);
+            Node* best = nullptr;
+            float bestScore = -1;
+            for (int a = 0; a < kActions; a++) {
+                Node* child = node->children[a];
+                if (!child) { continue; }
+                float mean = child->valueSum / child->visits;
+                float score = mean + kExploration * std::sqrt(logVisits / child->visits);
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = child;
+                }
+            }
+            if (!best) { break; }
+            node = best;
+            path[depth++] = node;
+        }
+
+        // Expansion: add the next untried move, or keep playing out from here once the arena is full
+        if (!node->state.isOver() && node->expanded < kActions && depth < 256) {
+            Node* child = worker.arena.create<Node>(node->state);
+            if (child) {
+                playAction(child->state, side, actionMoves[node->expanded], worker.rng);
+                node->children[node->expanded++] = child;
+                node = child;
+                path[depth++] = node;
+            }
+        }
+
+        // Simulation: random held moves for our side
+        GameCore playout = node->state;
+        for (int i = 0; i < kRolloutActions && !playout.isOver(); i++) {
+            playAction(playout, side, actionMoves[1 + nextRandom(worker.rng) % 4], worker.rng);
+        }
+        float value = pacmanValue(playout, rootPoints);
+        if (side == SIDE_GHOST) { value = 1.0f - value; }
+
+        // Backpropagation
+        for (int i = 0; i < depth; i++) {
+            path[i]->visits++;
+            path[i]->valueSum += value;
+        }
+        worker.playouts++;
+    }
+
+    for (int a = 0; a < kActions; a++) {
+        if (root->children[a]) { worker.rootVisits[a] = root->children[a]->visits; }
+    }
+    metricsAdd(METRIC_BOT_PLAYOUTS, worker.playouts);
+}
+
+uint8_t MctsBot::chooseMove(const GameCore& state) {
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(moveBudgetMs));
+
+    // Every helper thread searches its own tree from the same root
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        searchRoot = &state;
+        searchDeadline = deadline;
+        pending = (int)helpers.size();
+        generation++;
+    }
+    searchStart.notify_all();
+    search(workers[0], state, deadline);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        searchDone.wait(lock, [&] { return pending == 0; });
+    }
+
+    // Merge the trees by summing root visits, the most visited move wins
+    uint64_t visits[kActions] = {};
+    uint64_t playouts = 0;
+    for (const Worker& worker : workers) {
+        for (int a = 0; a < kActions; a++) { visits[a] += worker.rootVisits[a]; }
+        playouts += worker.playouts;
+    }
+    int best = 0;
+    for (int a = 1; a < kActions; a++) {
+        if (visits[a] > visits[best]) { best = a; }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    lastPlayouts = playouts;
+    lastPlayoutsPerSecond = seconds > 0 ? playouts / seconds : 0;
+    totalPlayouts += playouts;
+    totalSearchSeconds += seconds;
+    return actionMoves[best];
+}
+
+uint8_t MctsBot::nextMove(const GameCore& state) {
+    if (ticksLeft <= 0) {
+        heldMove = chooseMove(state);
+        ticksLeft = kTicksPerAction;
+    }
+    ticksLeft--;
+    return heldMove;
+}
@@ -0,0 +1,74 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "arena.h"
+#include "gamecore.h"
+
+// Which player a bot controls
+enum Side { SIDE_PACMAN, SIDE_GHOST };
+
+// Monte Carlo tree search player for either side of the game
+// Each thread grows its own tree from the same root (root parallelization)
+// inside a private arena, and the root visit counts are summed to pick a move
+// The helper threads live as long as the bot, so choosing a move does not allocate
+class MctsBot {
+public:
+    // A chosen move is held for this many ticks, one cell of Pacman travel
+    static constexpr int kTicksPerAction = 25;
+    static constexpr int kRolloutActions = 8;
+    static constexpr int kActions = 5;
+    static constexpr size_t kDefaultArenaBytes = 16u << 20;
+
+    // MctsBot constructor to set the side, search threads and time budget per move
+    MctsBot(Side side, int numThreads, double moveBudgetMs, size_t arenaBytesPerThread = kDefaultArenaBytes);
+    ~MctsBot();
+
+    // Method to search from state for at most the move budget and return the best move bits
+    uint8_t chooseMove(const GameCore& state);
+
+    // Method to return the move for this tick, searching again whenever the last one has been held long enough
+    uint8_t nextMove(const GameCore& state);
+
+    // Method to forget the held move, e.g. when a new game starts
+    void restart() { ticksLeft = 0; }
+
+    Side getSide() const { return side; }
+    uint64_t getLastPlayouts() const { return lastPlayouts; }
+    double getLastPlayoutsPerSecond() const { return lastPlayoutsPerSecond; }
+    uint64_t getTotalPlayouts() const { return totalPlayouts; }
+    double getTotalSearchSeconds() const { return totalSearchSeconds; }
+
+private:
+    struct Node;
+    struct Worker;
+
+    Side side;
+    double moveBudgetMs;
+    std::vector<Worker> workers;
+    uint8_t heldMove;
+    int ticksLeft;
+    uint64_t lastPlayouts;
+    double lastPlayoutsPerSecond;
+    uint64_t totalPlayouts;
+    double totalSearchSeconds;
+    std::vector<std::thread> helpers;
+    std::mutex mutex;
+    std::condition_variable searchStart;
+    std::condition_variable searchDone;
+    uint64_t generation;
+    int pending;
+    bool stopping;
+    const GameCore* searchRoot;
+    std::chrono::steady_clock::time_point searchDeadline;
+
+    void search(Worker& worker, const GameCore& root, std::chrono::steady_clock::time_point deadline);
+    void helperLoop(Worker& worker);
+};
+
+#endif // MCTS_H
@@ -0,0 +1,203 @@
+#include "metrics.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static_assert(sizeof(MetricsPage) == 4096, "the counters page must be exactly one page");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "metrics need lock-free 64-bit atomics");
+
+// Names and help text of the counters and gauges, in enum order
+static const char* const counterNames[METRIC_COUNTER_COUNT] = {
+    "pacman_ticks", "pacman_frames", "pacman_points", "pacman_games_won",
+    "pacman_games_lost", "pacman_input_events", "pacman_dropped_frames", "pacman_bot_playouts"
+};
+static const char* const counterHelp[METRIC_COUNTER_COUNT] = {
+    "Simulation ticks played.", "Frames rendered.", "Pellets eaten.", "Games won by Pacman.",
+    "Games lost by Pacman.", "Key presses and releases.", "60 Hz refreshes that passed without a new frame.",
+    "Monte Carlo tree search playouts."
+};
+static const char* const gaugeNames[METRIC_GAUGE_COUNT] = { "pacman_score", "pacman_pellets_left", "pacman_level" };
+static const char* const gaugeHelp[METRIC_GAUGE_COUNT] = {
+    "Score of the game being played.", "Pellets left in the maze.", "Number of the level being played, from 1."
+};
+
+static MetricsShard shards[kMaxMetricsThreads];
+static std::atomic<int> shardsClaimed(0);
+
+thread_local constinit MetricsShard* metricsLocalShard = nullptr;
+
+MetricsShard* metricsClaimShard() {
+    int index = shardsClaimed.fetch_add(1, std::memory_order_relaxed);
+    metricsLocalShard = &shards[index < kMaxMetricsThreads ? index : kMaxMetricsThreads - 1];
+    return metricsLocalShard;
+}
+
+void metricsSnapshot(MetricsSnapshot& snapshot) {
+    memset(&snapshot, 0, sizeof(snapshot));
+    int claimed = shardsClaimed.load(std::memory_order_relaxed);
+    if (claimed > kMaxMetricsThreads) { claimed = kMaxMetricsThreads; }
+    for (int s = 0; s < claimed; s++) {
+        const MetricsShard& shard = shards[s];
+        for (int i = 0; i < METRIC_COUNTER_COUNT; i++) { snapshot.counters[i] += shard.counters[i].load(std::memory_order_relaxed); }
+        for (int i = 0; i < METRIC_GAUGE_COUNT; i++) { snapshot.gauges[i] += shard.gauges[i].load(std::memory_order_relaxed); }
+        for (int i = 0; i < kFrameBuckets; i++) { snapshot.frameBuckets[i] += shard.frameBuckets[i].load(std::memory_order_relaxed); }
+        snapshot.frameMicrosSum += shard.frameMicrosSum.load(std::memory_order_relaxed);
+    }
+}
+
+// Method to call family(name, type, help) once before the samples of each
+// metric, then sample(name, value, scale) for each exported value, with the
+// name Prometheus uses; the value in the unit of the name is value / scale
+// Both the text file and the counters page are built from this one list
+// The histogram buckets are cumulative, as Prometheus expects
+template <class Family, class Sample>
+static void forEachSample(const MetricsSnapshot& snapshot, Family&& family, Sample&& sample) {
+    char name[sizeof(MetricsPageEntry::name)];
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        snprintf(name, sizeof(name), "%s_total", counterNames[i]);
+        family(name, "counter", counterHelp[i]);
+        sample(name, (int64_t)snapshot.counters[i], 1);
+    }
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+        family(gaugeNames[i], "gauge", gaugeHelp[i]);
+        sample(gaugeNames[i], snapshot.gauges[i], 1);
+    }
+
+    family("pacman_frame_seconds", "histogram", "Time between two rendered frames.");
+    uint64_t cumulative = 0;
+    for (int i = 0; i < kFrameBuckets; i++) {
+        cumulative += snapshot.frameBuckets[i];
+        if (i < kFrameBuckets - 1) {
+            snprintf(name, sizeof(name), "pacman_frame_seconds_bucket{le=\"%g\"}", kFrameBucketMicros[i] / 1e6);
+        } else {
+            snprintf(name, sizeof(name), "pacman_frame_seconds_bucket{le=\"+Inf\"}");
+        }
+        sample(name, (int64_t)cumulative, 1);
+    }
+    sample("pacman_frame_seconds_sum", (int64_t)snapshot.frameMicrosSum, 1000000);
+    sample("pacman_frame_seconds_count", (int64_t)cumulative, 1);
+}
+
+std::string metricsPrometheusText(const MetricsSnapshot& snapshot) {
+    std::string text;
+    char line[192];
+    forEachSample(snapshot, [&](const char* name, const char* type, const char* help) {
+        snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+        text += line;
+    }, [&](const char* name, int64_t value, uint32_t scale) {
+        if (scale == 1) {
+            snprintf(line, sizeof(line), "%s %lld\n", name, (long long)value);
+        } else {
+            snprintf(line, sizeof(line), "%s %.6f\n", name, (double)value / scale);
+        }
+        text += line;
+    });
+    return text;
+}
+
+// ** EXPORTER **
+
+MetricsExporter::MetricsExporter() : page(nullptr), intervalMs(1000), stopping(false) {}
+
+MetricsExporter::~MetricsExporter() { stop(); }
+
+bool MetricsExporter::start(const std::string& path, int exportIntervalMs) {
+    stop();
+    textPath = path + ".prom";
+    pagePath = path + ".page";
+    intervalMs = exportIntervalMs > 0 ? exportIntervalMs : 1000;
+
+    int fd = open(pagePath.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("open");
+        return false;
+    }
+    if (ftruncate(fd, sizeof(MetricsPage)) != 0) {
+        perror("ftruncate");
+        close(fd);
+        return false;
+    }
+    void* memory = mmap(nullptr, sizeof(MetricsPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+
+    // The names never change, so they are written once before the header becomes valid
+    page = static_cast<MetricsPage*>(memory);
+    memset((void*)page, 0, sizeof(MetricsPage));
+    MetricsSnapshot empty;
+    metricsSnapshot(empty);
+    uint32_t count = 0;
+    forEachSample(empty, [](const char*, const char*, const char*) {}, [&](const char* name, int64_t, uint32_t scale) {
+        if (count == MetricsPage::kMaxEntries) { return; }
+        MetricsPageEntry& entry = page->entries[count++];
+        snprintf(entry.name, sizeof(entry.name), "%s", name);
+        entry.scale = scale;
+    });
+    page->entryCount = count;
+    page->entrySize = sizeof(MetricsPageEntry);
+    page->version = MetricsPage::kVersion;
+    std::atomic_thread_fence(std::memory_order_release);
+    page->magic = MetricsPage::kMagic;
+
+    stopping = false;
+    worker = std::thread(&MetricsExporter::exportLoop, this);
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (!worker.joinable()) { return; }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+
+    // The files keep the last values; the page's update time tells readers they are stale
+    munmap(page, sizeof(MetricsPage));
+    page = nullptr;
+}
+
+void MetricsExporter::exportLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        bool last = wake.wait_for(lock, std::chrono::milliseconds(intervalMs), [&] { return stopping; });
+        lock.unlock();
+        exportOnce();
+        lock.lock();
+        if (last) { return; }
+    }
+}
+
+void MetricsExporter::exportOnce() {
+    MetricsSnapshot snapshot;
+    metricsSnapshot(snapshot);
+
+    // Readers of the page retry while the sequence is odd or changed under them
+    uint64_t sequence = page->sequence.load(std::memory_order_relaxed);
+    page->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    uint32_t i = 0;
+    forEachSample(snapshot, [](const char*, const char*, const char*) {}, [&](const char*, int64_t value, uint32_t) {
+        if (i < page->entryCount) { page->entries[i++].value = value; }
+    });
+    page->updateNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    page->sequence.store(sequence + 2, std::memory_order_release);
+
+    // Write the text file beside the old one and rename it over, so a scrape never sees half a file
+    std::string text = metricsPrometheusText(snapshot);
+    std::string tmpPath = textPath + ".tmp";
+    FILE* file = fopen(tmpPath.c_str(), "w");
+    if (!file) { return; }
+    bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+    written = fclose(file) == 0 && written;
+    if (!written || rename(tmpPath.c_str(), textPath.c_str()) != 0) { remove(tmpPath.c_str()); }
+}
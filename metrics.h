@@ -0,0 +1,157 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Live runtime metrics, readable from outside the process while it runs
+// Every thread updates its own cache-line aligned shard, so an update is one
+// relaxed atomic operation on memory no other thread writes; readers sum the
+// shards when they export, without ever stopping the writers
+
+// Monotonic counters, exported with a _total suffix
+enum MetricCounter {
+    METRIC_TICKS,          // simulation ticks played
+    METRIC_FRAMES,         // frames rendered
+    METRIC_POINTS,         // pellets eaten
+    METRIC_GAMES_WON,
+    METRIC_GAMES_LOST,
+    METRIC_INPUT_EVENTS,   // key presses and releases
+    METRIC_DROPPED_FRAMES, // 60 Hz refreshes that passed without a new frame
+    METRIC_BOT_PLAYOUTS,   // MCTS playouts, counted by every search thread
+    METRIC_COUNTER_COUNT
+};
+
+// Values that go up and down; a gauge is set by the thread that owns it and
+// the exported value is the sum over threads
+enum MetricGauge {
+    METRIC_SCORE,
+    METRIC_PELLETS_LEFT,
+    METRIC_LEVEL,
+    METRIC_GAUGE_COUNT
+};
+
+// Frame time histogram, bucket i counts frames up to kFrameBucketMicros[i]
+// and the last bucket everything slower
+static constexpr int kFrameBuckets = 9;
+static constexpr uint32_t kFrameBucketMicros[kFrameBuckets - 1] = {
+    1000, 2000, 4000, 8000, 16667, 33333, 50000, 100000
+};
+
+// One thread's metrics, on cache lines of their own
+struct alignas(64) MetricsShard {
+    std::atomic<uint64_t> counters[METRIC_COUNTER_COUNT];
+    std::atomic<int64_t> gauges[METRIC_GAUGE_COUNT];
+    std::atomic<uint64_t> frameBuckets[kFrameBuckets];
+    std::atomic<uint64_t> frameMicrosSum;
+};
+
+// The calling thread's shard, nullptr until its first update
+extern thread_local constinit MetricsShard* metricsLocalShard;
+
+// Method to give the calling thread a shard of its own
+// Past kMaxMetricsThreads threads the last shard is shared, which stays
+// correct for counters but lets those threads overwrite each other's gauges
+static constexpr int kMaxMetricsThreads = 64;
+MetricsShard* metricsClaimShard();
+
+inline MetricsShard& metricsShard() {
+    MetricsShard* shard = metricsLocalShard;
+    return shard ? *shard : *metricsClaimShard();
+}
+
+// Method to add n to a counter from the calling thread
+inline void metricsAdd(MetricCounter counter, uint64_t n = 1) {
+    metricsShard().counters[counter].fetch_add(n, std::memory_order_relaxed);
+}
+
+// Method to set the calling thread's share of a gauge
+inline void metricsSet(MetricGauge gauge, int64_t value) {
+    metricsShard().gauges[gauge].store(value, std::memory_order_relaxed);
+}
+
+// Method to record the time one frame took
+inline void metricsObserveFrame(uint32_t micros) {
+    int bucket = 0;
+    while (bucket < kFrameBuckets - 1 && micros > kFrameBucketMicros[bucket]) { bucket++; }
+    MetricsShard& shard = metricsShard();
+    shard.frameBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.frameMicrosSum.fetch_add(micros, std::memory_order_relaxed);
+}
+
+// Sum of every thread's shard at one moment
+struct MetricsSnapshot {
+    uint64_t counters[METRIC_COUNTER_COUNT];
+    int64_t gauges[METRIC_GAUGE_COUNT];
+    uint64_t frameBuckets[kFrameBuckets];
+    uint64_t frameMicrosSum;
+};
+
+// Method to add up all shards
+void metricsSnapshot(MetricsSnapshot& snapshot);
+
+// Method to format a snapshot in the Prometheus text exposition format
+std::string metricsPrometheusText(const MetricsSnapshot& snapshot);
+
+// One page of named values, mapped from a file so other processes can map it read-only
+// sequence is odd while the exporter rewrites the values, as in the broadcast ring
+// Entries have the same names as the text file; the value in the unit of the
+// name is value / scale, e.g. pacman_frame_seconds_sum is kept in microseconds
+struct MetricsPageEntry {
+    char name[52];
+    uint32_t scale;
+    int64_t value;
+};
+
+struct MetricsPage {
+    static constexpr uint32_t kMagic = 0x5041434D; // "PACM"
+    static constexpr uint32_t kVersion = 2;
+    static constexpr int kMaxEntries = 63;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t entrySize;
+    std::atomic<uint64_t> sequence;
+    int64_t updateNanos; // system clock of the last export
+    uint8_t padding[32];
+    MetricsPageEntry entries[kMaxEntries];
+};
+
+// Background thread writing a snapshot every interval to a Prometheus text
+// file (replaced atomically, for the node exporter textfile collector) and
+// to a memory-mapped counters page
+class MetricsExporter {
+private:
+    std::string textPath;
+    std::string pagePath;
+    MetricsPage* page;
+    int intervalMs;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    void exportLoop();
+    void exportOnce();
+
+public:
+    MetricsExporter();
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Method to start exporting to path.prom and path.page, returns false if the page cannot be mapped
+    bool start(const std::string& path, int exportIntervalMs = 1000);
+
+    // Method to write a last snapshot and stop the thread
+    void stop();
+};
+
+#endif // METRICS_H
@@ -4,8 +4,13 @@
 
 #include <cmath>
 #include <atomic>
+#ifdef __APPLE__
 #include <OpenGL/gl.h>
 #include <GLUT/glut.h>
+#else
+#include <GL/gl.h>
+#include <GL/glut.h>
+#endif
 
 class Pacman {
 private:
@@ -0,0 +1,60 @@
+/*
+ * Stable C interface to the vectorized Pacman environment.
+ * Every buffer is owned by the caller and must be contiguous:
+ *   obs     uint8_t [num_envs][channels][rows][cols]
+ *   actions int32_t [num_envs][2]  (Pacman action, ghost action)
+ *   rewards float   [num_envs]
+ *   dones   uint8_t [num_envs]
+ *   hashes  uint64_t[num_envs]
+ * Actions: 0 none, 1 up, 2 down, 3 left, 4 right.
+ * Channels: 0 walls, 1 pellets, 2 Pacman, 3 ghost.
+ * Pellet cells hold 1 for a pellet, 2 for a power pellet, 3 for the bonus item;
+ * the ghost cell holds 1 chasing, 2 frightened, 3 waiting at home.
+ * Rewards are from Pacman's side: 0.1 per point scored (pellet 10, power
+ * pellet 50, ghost 200, bonus 100), +10 for a cleared maze, -10 when caught.
+ *
+ * ABI version 2 introduced the 1/2/3 pellet and ghost encodings and the
+ * score-based reward; version 1 had 0/1 planes and 1 per pellet eaten.
+ */
+#ifndef PACMAN_ENV_H
+#define PACMAN_ENV_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define PACMAN_ENV_API __declspec(dllexport)
+#else
+#define PACMAN_ENV_API __attribute__((visibility("default")))
+#endif
+
+#define PACMAN_ENV_ABI_VERSION 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PacmanEnv PacmanEnv;
+
+PACMAN_ENV_API int pacman_env_abi_version(void);
+
+/* Returns NULL if num_envs is not positive or memory runs out.
+ * max_episode_ticks <= 0 selects the default episode length. */
+PACMAN_ENV_API PacmanEnv* pacman_env_create(int num_envs, int max_episode_ticks);
+PACMAN_ENV_API void pacman_env_destroy(PacmanEnv* env);
+
+PACMAN_ENV_API int pacman_env_num_envs(const PacmanEnv* env);
+PACMAN_ENV_API void pacman_env_obs_shape(int* channels, int* rows, int* cols);
+
+PACMAN_ENV_API void pacman_env_reset(PacmanEnv* env, uint8_t* obs);
+PACMAN_ENV_API void pacman_env_step(PacmanEnv* env, const int32_t* actions,
+                                    uint8_t* obs, float* rewards, uint8_t* dones);
+
+/* Hash of each game's full state. The simulation uses integer math only,
+ * so equal inputs give equal hashes on every machine and build. */
+PACMAN_ENV_API void pacman_env_state_hashes(const PacmanEnv* env, uint64_t* hashes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PACMAN_ENV_H */
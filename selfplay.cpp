@@ -0,0 +1,59 @@
+// Headless match between two MCTS bots, one playing Pacman and one the ghost
+// Usage: pacman_selfplay [games] [move budget in ms] [threads per bot]
+
+#include "allocstats.h"
+#include "gamecore.h"
+#include "mcts.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+// Give up on a game that runs this long, e.g. when both bots stall
+static const int kMaxTicks = 20000;
+
+int main(int argc, char** argv) {
+    int games = argc > 1 ? atoi(argv[1]) : 5;
+    double budgetMs = argc > 2 ? atof(argv[2]) : 10.0;
+    int threads = argc > 3 ? atoi(argv[3]) : (int)max(1u, thread::hardware_concurrency() / 2);
+
+    // Count the allocations of this thread and of the bots' helper threads
+    setAllocationCounting(true);
+    MctsBot pacmanBot(SIDE_PACMAN, threads, budgetMs);
+    MctsBot ghostBot(SIDE_GHOST, threads, budgetMs);
+
+    int pacmanWins = 0;
+    int ghostWins = 0;
+    for (int g = 0; g < games; g++) {
+        GameCore core;
+        pacmanBot.restart();
+        ghostBot.restart();
+
+        uint64_t allocationsBefore = allocationCount();
+        int ticks = 0;
+        while (!core.isOver() && ticks < kMaxTicks) {
+            core.step(pacmanBot.nextMove(core), ghostBot.nextMove(core));
+            ticks++;
+        }
+
+        const char* result = !core.isOver() ? "draw" : (core.isWon() ? "Pacman" : "Ghost");
+        if (core.isOver()) { core.isWon() ? pacmanWins++ : ghostWins++; }
+        cout << "Game " << g + 1 << ": " << result << " after " << ticks << " ticks, "
+             << core.getPoints() << " points" << endl;
+        if (allocationCountingEnabled()) {
+            cout << "  heap allocations during play: " << allocationCount() - allocationsBefore << endl;
+        }
+    }
+
+    cout << "Pacman " << pacmanWins << " - " << ghostWins << " Ghost" << endl;
+    // No search ran when no game was played, so there is no rate to report
+    double pacmanSeconds = pacmanBot.getTotalSearchSeconds();
+    double ghostSeconds = ghostBot.getTotalSearchSeconds();
+    cout << "Pacman bot: " << (uint64_t)(pacmanSeconds > 0 ? pacmanBot.getTotalPlayouts() / pacmanSeconds : 0)
+         << " playouts/s on " << threads << " threads" << endl;
+    cout << "Ghost bot:  " << (uint64_t)(ghostSeconds > 0 ? ghostBot.getTotalPlayouts() / ghostSeconds : 0)
+         << " playouts/s on " << threads << " threads" << endl;
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Headless viewer that follows a game broadcast and prints lag statistics once a second
+// Usage: pacman_spectator [shared memory name] [seconds to watch, 0 = forever]
+
+#include "broadcast.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    const char* name = argc > 1 ? argv[1] : "/pacman_broadcast";
+    int seconds = argc > 2 ? atoi(argv[2]) : 0;
+
+    Spectator spectator;
+    while (!spectator.open(name)) {
+        cout << "Waiting for a broadcast on " << name << " ..." << endl;
+        this_thread::sleep_for(chrono::seconds(1));
+    }
+
+    // The pellet set is only known once the first keyframe has arrived
+    uint64_t pellets[GameCore::kPelletWords] = {};
+    int pelletWords = 0;
+    bool havePellets = false;
+
+    // Nothing about the game is known until the first frame has been read
+    BroadcastFrame frame = {};
+    bool haveFrame = false;
+    auto start = chrono::steady_clock::now();
+    auto nextReport = start + chrono::seconds(1);
+    uint64_t frames = 0;
+    uint64_t skippedBefore = 0;
+    uint64_t skippedSeen = 0;
+    int64_t lagSum = 0;
+    int64_t lagMin = INT64_MAX;
+    int64_t lagMax = 0;
+    uint64_t maxBehind = 0;
+
+    for (;;) {
+        if (spectator.read(frame) == Spectator::FRAME_READ) {
+            int64_t lag = chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now().time_since_epoch()).count() - frame.publishNanos;
+            lagSum += lag;
+            lagMin = min(lagMin, lag);
+            lagMax = max(lagMax, lag);
+            maxBehind = max(maxBehind, spectator.getLag());
+            frames++;
+            haveFrame = true;
+
+            // Deltas were lost with the frames we were lapped on, so wait for the next keyframe
+            if (spectator.getSkipped() != skippedSeen) {
+                skippedSeen = spectator.getSkipped();
+                havePellets = false;
+            }
+            if (frame.keyframe) { pelletWords = frame.pelletWords; }
+            for (int i = 0; i < pelletWords; i++) {
+                pellets[i] = frame.keyframe ? frame.pellets[i] : pellets[i] & ~frame.pellets[i];
+            }
+            havePellets = havePellets || frame.keyframe;
+        } else {
+            this_thread::sleep_for(chrono::microseconds(200));
+        }
+
+        auto now = chrono::steady_clock::now();
+        if (now < nextReport) { continue; }
+
+        int remaining = 0;
+        for (int i = 0; i < pelletWords; i++) { remaining += __builtin_popcountll(pellets[i]); }
+
+        cout << "frames " << frames << "  skipped " << spectator.getSkipped() - skippedBefore;
+        if (frames > 0) {
+            cout << "  lag us min/avg/max " << lagMin / 1000 << '/' << lagSum / (int64_t)frames / 1000 << '/' << lagMax / 1000
+                 << "  max ticks behind " << maxBehind;
+        }
+        if (haveFrame) {
+            cout << "  tick " << frame.tick << "  maze " << (int)frame.cols << 'x' << (int)frame.rows
+                 << "  points " << frame.points << "  score " << frame.score;
+        }
+        if (havePellets) { cout << "  pellets left " << remaining; }
+        cout << (haveFrame && frame.over ? "  [over]" : "") << endl;
+
+        frames = 0;
+        skippedBefore = spectator.getSkipped();
+        lagSum = 0;
+        lagMin = INT64_MAX;
+        lagMax = 0;
+        maxBehind = 0;
+        nextReport += chrono::seconds(1);
+        if (seconds > 0 && now - start >= chrono::seconds(seconds)) { break; }
+    }
+    return 0;
+}
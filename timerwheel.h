@@ -0,0 +1,140 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <cstdint>
+
+// Hierarchical timer wheel keyed on simulation ticks
+// Levels wheels of 2^SlotBits slots each; level L holds timers due within the current turn of level L + 1
+// and its timers are moved down one level whenever the level below wraps around
+// schedule() and cancel() are O(1); advance() only touches timers that fire or cascade
+// Timers live in a fixed array linked by index, so the whole wheel can be copied with the state it belongs to
+template <int Capacity, int SlotBits = 6, int Levels = 4>
+class TimerWheel {
+public:
+    static constexpr int kSlots = 1 << SlotBits;
+    static constexpr uint64_t kMaxDelay = (uint64_t)(kSlots - 1) << (SlotBits * (Levels - 1));
+    static constexpr int kNone = -1;
+
+    // TimerWheel constructor to start at tick 0 with no timers
+    TimerWheel() { clear(); }
+
+    // Method to drop every timer and go back to tick 0
+    void clear() {
+        now = 0;
+        for (int i = 0; i < Levels * kSlots; i++) { heads[i] = kNone; }
+        for (int i = 0; i < Capacity; i++) {
+            timers[i].next = i + 1 < Capacity ? i + 1 : kNone;
+            timers[i].slot = kNone;
+        }
+        freeHead = Capacity > 0 ? 0 : kNone;
+    }
+
+    // Method to fire event after delay ticks (at least 1, at most kMaxDelay)
+    // Returns the timer id, or kNone when every timer is in use
+    int schedule(uint64_t delay, uint32_t event) {
+        if (freeHead == kNone) { return kNone; }
+        if (delay < 1) { delay = 1; }
+        if (delay > kMaxDelay) { delay = kMaxDelay; }
+
+        int id = freeHead;
+        freeHead = timers[id].next;
+        timers[id].due = now + delay;
+        timers[id].event = event;
+        link(id);
+        return id;
+    }
+
+    // Method to stop a pending timer, returns false if id is not pending
+    bool cancel(int id) {
+        if (id < 0 || id >= Capacity || timers[id].slot == kNone) { return false; }
+        unlink(id);
+        release(id);
+        return true;
+    }
+
+    bool isPending(int id) const { return id >= 0 && id < Capacity && timers[id].slot != kNone; }
+
+    // Ticks until a pending timer fires
+    uint64_t remaining(int id) const { return timers[id].due - now; }
+
+    uint64_t getNow() const { return now; }
+
+    // Method to move one tick forward and call fire(id, event) for every timer that is due
+    // fire may schedule or cancel timers, including the one being fired
+    template <class Fire>
+    void advance(Fire&& fire) {
+        now++;
+
+        // Bring timers down from the outer levels whose slot comes up on this tick, outermost first
+        for (int level = Levels - 1; level > 0; level--) {
+            uint64_t mask = (1ull << (SlotBits * level)) - 1;
+            if ((now & mask) == 0) { cascade(level); }
+        }
+
+        // Everything left in the current innermost slot is due now
+        int slot = (int)(now & (kSlots - 1));
+        int id;
+        while ((id = heads[slot]) != kNone) {
+            unlink(id);
+            uint32_t event = timers[id].event;
+            release(id);
+            fire(id, event);
+        }
+    }
+
+private:
+    struct Timer {
+        uint64_t due;
+        uint32_t event;
+        int16_t next;
+        int16_t prev;
+        int16_t slot; // index into heads, kNone while the timer is free
+    };
+
+    Timer timers[Capacity];
+    int16_t heads[Levels * kSlots];
+    int16_t freeHead;
+    uint64_t now;
+
+    // Method to put a timer in the innermost level whose current rotation contains its due tick
+    void link(int id) {
+        uint64_t due = timers[id].due;
+        int level = 0;
+        while (level < Levels - 1 && (due >> (SlotBits * (level + 1))) != (now >> (SlotBits * (level + 1)))) {
+            level++;
+        }
+        int slot = level * kSlots + (int)((due >> (SlotBits * level)) & (kSlots - 1));
+
+        timers[id].slot = slot;
+        timers[id].prev = kNone;
+        timers[id].next = heads[slot];
+        if (heads[slot] != kNone) { timers[heads[slot]].prev = id; }
+        heads[slot] = id;
+    }
+
+    void unlink(int id) {
+        Timer& timer = timers[id];
+        if (timer.prev != kNone) { timers[timer.prev].next = timer.next; } else { heads[timer.slot] = timer.next; }
+        if (timer.next != kNone) { timers[timer.next].prev = timer.prev; }
+        timer.slot = kNone;
+    }
+
+    void release(int id) {
+        timers[id].slot = kNone;
+        timers[id].next = freeHead;
+        freeHead = id;
+    }
+
+    void cascade(int level) {
+        int slot = level * kSlots + (int)((now >> (SlotBits * level)) & (kSlots - 1));
+        int id = heads[slot];
+        heads[slot] = kNone;
+        while (id != kNone) {
+            int next = timers[id].next;
+            link(id);
+            id = next;
+        }
+    }
+};
+
+#endif // TIMERWHEEL_H
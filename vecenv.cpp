@@ -0,0 +1,92 @@
+#include "vecenv.h"
+#include "pacman_env.h"
+
+#include <cstddef>
+#include <new>
+
+// Movement bits for each discrete action
+static const uint8_t actionMoves[VecEnv::ACTION_COUNT] = {
+    MOVE_NONE, MOVE_UP, MOVE_DOWN, MOVE_LEFT, MOVE_RIGHT
+};
+
+static uint8_t toMoves(int32_t action) {
+    return (action > 0 && action < VecEnv::ACTION_COUNT) ? actionMoves[action] : (uint8_t)MOVE_NONE;
+}
+
+VecEnv::VecEnv(int numEnvs, int maxEpisodeTicks)
+    : envs(numEnvs), episodeTicks(numEnvs, 0),
+      maxEpisodeTicks(maxEpisodeTicks > 0 ? maxEpisodeTicks : kDefaultMaxEpisodeTicks),
+      obsSize(kChannels * Level::builtin()->getCells()) {}
+
+void VecEnv::reset(uint8_t* obs) {
+    for (int i = 0; i < size(); i++) {
+        envs[i].reset();
+        episodeTicks[i] = 0;
+        envs[i].writeObservation(obs + (size_t)i * obsSize);
+    }
+}
+
+void VecEnv::step(const int32_t* actions, uint8_t* obs, float* rewards, uint8_t* dones) {
+    for (int i = 0; i < size(); i++) {
+        GameCore& env = envs[i];
+        int scoreBefore = env.getScore();
+        env.step(toMoves(actions[2 * i]), toMoves(actions[2 * i + 1]));
+        float reward = (env.getScore() - scoreBefore) * kScoreReward;
+
+        bool done = env.isOver() || ++episodeTicks[i] >= maxEpisodeTicks;
+        if (env.isOver()) { reward += env.isWon() ? kWinReward : kCaughtReward; }
+
+        // Start the next episode straight away so the batch never stalls
+        if (done) {
+            env.reset();
+            episodeTicks[i] = 0;
+        }
+
+        rewards[i] = reward;
+        dones[i] = done;
+        env.writeObservation(obs + (size_t)i * obsSize);
+    }
+}
+
+void VecEnv::stateHashes(uint64_t* hashes) const {
+    for (int i = 0; i < size(); i++) { hashes[i] = envs[i].stateHash(); }
+}
+
+// ** C INTERFACE **
+
+struct PacmanEnv {
+    VecEnv vec;
+    PacmanEnv(int numEnvs, int maxEpisodeTicks) : vec(numEnvs, maxEpisodeTicks) {}
+};
+
+int pacman_env_abi_version(void) { return PACMAN_ENV_ABI_VERSION; }
+
+PacmanEnv* pacman_env_create(int num_envs, int max_episode_ticks) {
+    if (num_envs <= 0) { return nullptr; }
+
+    // No exception may cross the C boundary
+    try {
+        return new PacmanEnv(num_envs, max_episode_ticks);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void pacman_env_destroy(PacmanEnv* env) { delete env; }
+
+int pacman_env_num_envs(const PacmanEnv* env) { return env->vec.size(); }
+
+void pacman_env_obs_shape(int* channels, int* rows, int* cols) {
+    *channels = VecEnv::kChannels;
+    *rows = Level::builtin()->getRows();
+    *cols = Level::builtin()->getCols();
+}
+
+void pacman_env_reset(PacmanEnv* env, uint8_t* obs) { env->vec.reset(obs); }
+
+void pacman_env_step(PacmanEnv* env, const int32_t* actions,
+                     uint8_t* obs, float* rewards, uint8_t* dones) {
+    env->vec.step(actions, obs, rewards, dones);
+}
+
+void pacman_env_state_hashes(const PacmanEnv* env, uint64_t* hashes) { env->vec.stateHashes(hashes); }
@@ -0,0 +1,57 @@
+#ifndef VECENV_H
+#define VECENV_H
+
+#include <cstdint>
+#include <vector>
+#include "gamecore.h"
+
+// A batch of independent games stepped in lockstep for reinforcement learning
+// Every game is played on the built-in maze
+// Observations are written straight into caller-owned buffers, one block of
+// getObsSize() bytes per environment, laid out as [env][channel][row][col]
+class VecEnv {
+public:
+    // Discrete actions understood by step(), one per player per environment
+    enum Action {
+        ACTION_NOOP = 0,
+        ACTION_UP,
+        ACTION_DOWN,
+        ACTION_LEFT,
+        ACTION_RIGHT,
+        ACTION_COUNT
+    };
+
+    static constexpr int kChannels = 4;
+    static constexpr int kDefaultMaxEpisodeTicks = 20000;
+
+    // Rewards are from Pacman's point of view, a ghost agent should negate them
+    // Eating earns the score gained scaled by kScoreReward (a pellet is worth 1)
+    static constexpr float kScoreReward = 0.1f;
+    static constexpr float kWinReward = 10.0f;
+    static constexpr float kCaughtReward = -10.0f;
+
+    // VecEnv constructor to create numEnvs games, each cut off after maxEpisodeTicks
+    explicit VecEnv(int numEnvs, int maxEpisodeTicks = kDefaultMaxEpisodeTicks);
+
+    int size() const { return (int)envs.size(); }
+    int getObsSize() const { return obsSize; }
+
+    // Method to restart every game and write the first observations
+    void reset(uint8_t* obs);
+
+    // Method to advance every game by one tick
+    // actions holds two entries per environment: Pacman's, then the ghost's
+    // Finished games are restarted at once and obs holds their first observation
+    void step(const int32_t* actions, uint8_t* obs, float* rewards, uint8_t* dones);
+
+    // Method to write GameCore::stateHash() of every game, for desync checks
+    void stateHashes(uint64_t* hashes) const;
+
+private:
+    std::vector<GameCore> envs;
+    std::vector<int> episodeTicks;
+    int maxEpisodeTicks;
+    int obsSize;
+};
+
+#endif // VECENV_H